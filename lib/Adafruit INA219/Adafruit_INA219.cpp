@@ -38,6 +38,7 @@ Adafruit_INA219::Adafruit_INA219(uint8_t addr) {
   ina219_i2caddr = addr;
   ina219_currentDivider_mA = 0;
   ina219_powerMultiplier_mW = 0.0f;
+  ina219_rewriteCal = true;
 }
 
 /*!
@@ -108,9 +109,11 @@ int16_t Adafruit_INA219::getCurrent_raw() {
   // reset the cal register, meaning CURRENT and POWER will
   // not be available ... avoid this by always setting a cal
   // value even if it's an unfortunate extra step
-  Adafruit_BusIO_Register calibration_reg =
-      Adafruit_BusIO_Register(i2c_dev, INA219_REG_CALIBRATION, 2, MSBFIRST);
-  calibration_reg.write(ina219_calValue, 2);
+  if (ina219_rewriteCal) {
+    Adafruit_BusIO_Register calibration_reg =
+        Adafruit_BusIO_Register(i2c_dev, INA219_REG_CALIBRATION, 2, MSBFIRST);
+    calibration_reg.write(ina219_calValue, 2);
+  }
 
   // Now we can safely read the CURRENT register!
   Adafruit_BusIO_Register current_reg =
@@ -130,9 +133,11 @@ int16_t Adafruit_INA219::getPower_raw() {
   // reset the cal register, meaning CURRENT and POWER will
   // not be available ... avoid this by always setting a cal
   // value even if it's an unfortunate extra step
-  Adafruit_BusIO_Register calibration_reg =
-      Adafruit_BusIO_Register(i2c_dev, INA219_REG_CALIBRATION, 2, MSBFIRST);
-  calibration_reg.write(ina219_calValue, 2);
+  if (ina219_rewriteCal) {
+    Adafruit_BusIO_Register calibration_reg =
+        Adafruit_BusIO_Register(i2c_dev, INA219_REG_CALIBRATION, 2, MSBFIRST);
+    calibration_reg.write(ina219_calValue, 2);
+  }
 
   // Now we can safely read the POWER register!
   Adafruit_BusIO_Register power_reg =
@@ -225,6 +230,54 @@ void Adafruit_INA219::powerSave(bool on) {
   }
 }
 
+/*!
+ *  @brief  Enables or disables the calibration write before every current
+ *          and power read (enabled by default)
+ *  @param  on
+ *          false saves one I2C transaction per read, but a brown-out reset
+ *          of the chip clears the calibration and current/power then read 0
+ *          until a setCalibration_* call
+ */
+void Adafruit_INA219::setCalibrationRewrite(bool on) { ina219_rewriteCal = on; }
+
+/*!
+ *  @brief  Sets the bus and shunt ADC resolution/averaging, keeping the
+ *          range, gain and operating mode
+ *  @param  busADC
+ *          one of INA219_CONFIG_BADCRES_*
+ *  @param  shuntADC
+ *          one of INA219_CONFIG_SADCRES_*
+ *  @return true: success false: the config register could not be accessed
+ */
+bool Adafruit_INA219::setADCResolution(uint16_t busADC, uint16_t shuntADC) {
+  uint16_t config;
+  Adafruit_BusIO_Register config_reg =
+      Adafruit_BusIO_Register(i2c_dev, INA219_REG_CONFIG, 2, MSBFIRST);
+  if (!config_reg.read(&config)) {
+    _success = false;
+    return false;
+  }
+  config &= ~(INA219_CONFIG_BADCRES_MASK | INA219_CONFIG_SADCRES_MASK);
+  config |= (busADC & INA219_CONFIG_BADCRES_MASK) |
+            (shuntADC & INA219_CONFIG_SADCRES_MASK);
+  _success = config_reg.write(config, 2);
+  return _success;
+}
+
+/*!
+ *  @brief  Reads the conversion ready (CNVR) bit of the bus voltage register.
+ *          The bit is set when a conversion completes and cleared by reading
+ *          the power register
+ *  @return true: new results are available since the last power read
+ */
+bool Adafruit_INA219::conversionReady() {
+  uint16_t value = 0;
+  Adafruit_BusIO_Register bus_voltage_reg =
+      Adafruit_BusIO_Register(i2c_dev, INA219_REG_BUSVOLTAGE, 2, MSBFIRST);
+  _success = bus_voltage_reg.read(&value);
+  return _success && (value & 0x02);
+}
+
 /*!
  *  @brief  Configures to INA219 to be able to measure up to 32V and 1A
  *          of current.  Each unit of current corresponds to 40uA, and each
@@ -175,6 +175,9 @@ public:
   float getPower_mW();
   void powerSave(bool on);
   bool success();
+  void setCalibrationRewrite(bool on);
+  bool setADCResolution(uint16_t busADC, uint16_t shuntADC);
+  bool conversionReady();
 
 private:
   Adafruit_I2CDevice *i2c_dev = NULL;
@@ -183,6 +186,8 @@ private:
 
   uint8_t ina219_i2caddr = -1;
   uint32_t ina219_calValue;
+  bool ina219_rewriteCal; /*!< rewrite the calibration register before
+                             current and power reads */
   // The following multipliers are used to convert raw current and power
   // values to mA and mW, taking into account the current config settings
   uint32_t ina219_currentDivider_mA;
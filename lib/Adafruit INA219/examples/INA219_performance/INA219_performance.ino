@@ -0,0 +1,170 @@
+//
+//    FILE: INA219_performance.ino
+// PURPOSE: per-call timing of the INA219 driver at different I2C clocks
+//          and ADC modes, and the achievable end-to-end sample rate
+//
+//  Each call is timed as the mean of RUNS calls. A "snapshot" is the
+//  sequence PowerMonitor uses for one sample: calibration write, then
+//  current, bus voltage and power reads.
+//
+//  New results are available once per conversion (bus + shunt ADC time),
+//  measured here with the CNVR bit. The achievable sample rate is the
+//  lower of the transfer-limited rate (1 / snapshot time) and the
+//  conversion-limited rate (1 / conversion time).
+
+
+#include <Wire.h>
+#include <Adafruit_INA219.h>
+
+
+#define RUNS 100
+
+Adafruit_INA219 ina219;
+uint32_t start, stop;
+
+struct AdcMode
+{
+  const char * name;
+  uint16_t busADC;
+  uint16_t shuntADC;
+};
+
+const AdcMode modes[] =
+{
+  { "9 bit",            INA219_CONFIG_BADCRES_9BIT,            INA219_CONFIG_SADCRES_9BIT_1S_84US },
+  { "12 bit",           INA219_CONFIG_BADCRES_12BIT,           INA219_CONFIG_SADCRES_12BIT_1S_532US },
+  { "12 bit, 8 avg",    INA219_CONFIG_BADCRES_12BIT_8S_4260US, INA219_CONFIG_SADCRES_12BIT_8S_4260US },
+  { "12 bit, 128 avg",  INA219_CONFIG_BADCRES_12BIT_128S_69MS, INA219_CONFIG_SADCRES_12BIT_128S_69MS },
+};
+
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial) delay(1);
+  Serial.println(__FILE__);
+  Serial.println();
+
+  Wire.begin();
+
+  if (!ina219.begin())
+  {
+    Serial.println("could not connect. Fix and Reboot");
+    while (1) delay(10);
+  }
+
+  const uint32_t speeds[] = { 100000, 400000 };
+  for (uint8_t s = 0; s < 2; s++)
+  {
+    for (uint8_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    {
+      performance(speeds[s], modes[m]);
+    }
+  }
+
+  //  back to the defaults
+  Wire.setClock(100000);
+  ina219.setCalibrationRewrite(true);
+  ina219.setCalibration_32V_2A();
+  Serial.println("\ndone...");
+}
+
+
+void performance(uint32_t speed, const AdcMode & mode)
+{
+  Wire.setClock(speed);
+  ina219.setCalibrationRewrite(true);
+  ina219.setADCResolution(mode.busADC, mode.shuntADC);
+
+  Serial.print("\nSpeed:\t");
+  Serial.print(speed);
+  Serial.print("\tADC:\t");
+  Serial.println(mode.name);
+
+  delay(100);  //  flush IO
+
+  float busVoltage = 0;
+  start = micros();
+  for (int i = 0; i < RUNS; i++) busVoltage = ina219.getBusVoltage_V();
+  stop = micros();
+  report("BUS V", busVoltage, stop - start);
+
+  float shuntVoltage = 0;
+  start = micros();
+  for (int i = 0; i < RUNS; i++) shuntVoltage = ina219.getShuntVoltage_mV();
+  stop = micros();
+  report("SHUNT mV", shuntVoltage, stop - start);
+
+  float mA = 0;
+  start = micros();
+  for (int i = 0; i < RUNS; i++) mA = ina219.getCurrent_mA();
+  stop = micros();
+  report("mA (cal)", mA, stop - start);
+
+  ina219.setCalibrationRewrite(false);
+  start = micros();
+  for (int i = 0; i < RUNS; i++) mA = ina219.getCurrent_mA();
+  stop = micros();
+  report("mA (no cal)", mA, stop - start);
+
+  float mW = 0;
+  start = micros();
+  for (int i = 0; i < RUNS; i++) mW = ina219.getPower_mW();
+  stop = micros();
+  report("mW (no cal)", mW, stop - start);
+
+  //  one PowerMonitor sample
+  start = micros();
+  for (int i = 0; i < RUNS; i++)
+  {
+    ina219.setCalibrationRewrite(true);
+    mA = ina219.getCurrent_mA();
+    ina219.setCalibrationRewrite(false);
+    busVoltage = ina219.getBusVoltage_V();
+    mW = ina219.getPower_mW();
+  }
+  stop = micros();
+  float snapshotUs = (stop - start) / (float)RUNS;
+  report("SNAPSHOT", mW, stop - start);
+
+  //  reading the power register clears CNVR, the next conversion sets it
+  uint32_t conversionUs = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    ina219.getPower_mW();
+    start = micros();
+    while (!ina219.conversionReady() && micros() - start < 200000) {}
+    stop = micros();
+    if (stop - start > conversionUs) conversionUs = stop - start;
+  }
+  Serial.print("CONVERSION us:\t");
+  Serial.println(conversionUs);
+
+  float transferRate = 1e6 / snapshotUs;
+  float conversionRate = conversionUs > 0 ? 1e6 / conversionUs : transferRate;
+  Serial.print("RATE Hz:\t");
+  Serial.print(transferRate < conversionRate ? transferRate : conversionRate, 1);
+  Serial.print("\t(transfer ");
+  Serial.print(transferRate, 1);
+  Serial.print(", conversion ");
+  Serial.print(conversionRate, 1);
+  Serial.println(")");
+}
+
+
+//  value of the last call and the mean time per call in us
+void report(const char * label, float value, uint32_t total)
+{
+  Serial.print(label);
+  Serial.print(":\t");
+  Serial.print(value, 3);
+  Serial.print("\t");
+  Serial.println(total / (float)RUNS, 1);
+}
+
+
+void loop()
+{
+}
+
+//  -- END OF FILE --
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <Arduino.h>
+#include <math.h>
+
+// 每个用例最多计时的批数；预热另计一批
+#define BENCH_MAX_BATCHES 32
+#define BENCH_DEFAULT_BATCHES 20
+
+// 一个用例的结果，耗时单位为每次调用的纳秒数，统计量取自各批的平均
+struct BenchResult {
+    const char* name;
+    uint32_t iterations;    // 每批调用次数
+    uint8_t batches;
+    float min;
+    float median;
+    float mean;
+    float p95;
+    float max;
+    float stddev;
+};
+
+// 微基准：连续调用 fn iterations 次为一批，先空跑一批预热（缓存、闪存映射、惰性初始化），
+// 再计时 batches 批。单次调用往往只有几个微秒，按批计时可把计时本身的开销摊薄；
+// 批间的离散程度（stddev、p95）反映中断、WiFi 等干扰。
+// 计时钟由调用方给出：设备上为 ESP.getCycleCount()，主机上为单调时钟或模拟时钟
+class Bench {
+public:
+    typedef uint32_t (*Clock)();
+
+    Bench(Clock clock, float nsPerTick) : clock(clock), nsPerTick(nsPerTick) {}
+
+    // 设备上的默认计时钟：CPU 周期计数，80MHz 下约49秒回绕一次，单批远小于此
+    static uint32_t cycleClock() { return ESP.getCycleCount(); }
+    static float cycleNs() { return 1000.0f / ESP.getCpuFreqMHz(); }
+
+    template <typename F>
+    BenchResult run(const char* name, F fn, uint32_t iterations, uint8_t batches = BENCH_DEFAULT_BATCHES) {
+        if (iterations == 0) iterations = 1;
+        if (batches == 0) batches = 1;
+        if (batches > BENCH_MAX_BATCHES) batches = BENCH_MAX_BATCHES;
+
+        for (uint32_t i = 0; i < iterations; i++) fn();
+        yield();
+
+        float perCall[BENCH_MAX_BATCHES];
+        for (uint8_t b = 0; b < batches; b++) {
+            uint32_t start = clock();
+            for (uint32_t i = 0; i < iterations; i++) fn();
+            uint32_t ticks = clock() - start;
+            perCall[b] = ticks * nsPerTick / iterations;
+            // 批与批之间让出 CPU，长用例不会触发看门狗，WiFi 也不会断开
+            yield();
+        }
+        return summarize(name, iterations, perCall, batches);
+    }
+
+    // 表格输出：表头和每个用例一行，单位 ns/次
+    static size_t formatHeader(char* out, size_t size) {
+        int n = snprintf(out, size, "%-22s %8s %10s %10s %10s %10s %10s\n",
+                         "case", "iters", "min", "median", "p95", "max", "stddev");
+        return n > 0 && (size_t)n < size ? n : 0;
+    }
+
+    static size_t formatRow(const BenchResult& r, char* out, size_t size) {
+        int n = snprintf(out, size, "%-22s %8lu %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                         r.name, (unsigned long)r.iterations, r.min, r.median, r.p95, r.max, r.stddev);
+        return n > 0 && (size_t)n < size ? n : 0;
+    }
+
+    // JSON 输出：单个用例一个对象，由调用方组成数组
+    static size_t formatJson(const BenchResult& r, char* out, size_t size) {
+        int n = snprintf(out, size,
+                         "{\"name\":\"%s\",\"iterations\":%lu,\"batches\":%u,\"min\":%.1f,\"median\":%.1f,"
+                         "\"mean\":%.1f,\"p95\":%.1f,\"max\":%.1f,\"stddev\":%.1f}",
+                         r.name, (unsigned long)r.iterations, (unsigned)r.batches, r.min, r.median,
+                         r.mean, r.p95, r.max, r.stddev);
+        return n > 0 && (size_t)n < size ? n : 0;
+    }
+
+private:
+    Clock clock;
+    float nsPerTick;
+
+    static BenchResult summarize(const char* name, uint32_t iterations, float* values, uint8_t count) {
+        // 批数很少，插入排序即可
+        for (uint8_t i = 1; i < count; i++) {
+            float v = values[i];
+            int j = i - 1;
+            while (j >= 0 && values[j] > v) {
+                values[j + 1] = values[j];
+                j--;
+            }
+            values[j + 1] = v;
+        }
+        float sum = 0;
+        for (uint8_t i = 0; i < count; i++) sum += values[i];
+        float mean = sum / count;
+        float variance = 0;
+        for (uint8_t i = 0; i < count; i++) variance += (values[i] - mean) * (values[i] - mean);
+
+        BenchResult r;
+        r.name = name;
+        r.iterations = iterations;
+        r.batches = count;
+        r.min = values[0];
+        r.median = count % 2 ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2;
+        r.mean = mean;
+        r.p95 = values[(count * 95 + 99) / 100 - 1];
+        r.max = values[count - 1];
+        r.stddev = sqrtf(variance / count);
+        return r;
+    }
+};
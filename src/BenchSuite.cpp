@@ -0,0 +1,139 @@
+#include "BenchSuite.h"
+#include "Deadband.h"
+#include "PowerCodec.h"
+#include "SnapshotCache.h"
+#include "Telemetry.h"
+
+// 批量负载的样本数，与默认批量大小相当
+#define BENCH_BATCH_SAMPLES 20
+
+// 写入结果，防止编译器把被测调用当作无用代码删掉
+static volatile size_t benchSideEffect;
+
+static PowerSample benchSample(uint32_t seq) {
+    PowerSample s;
+    s.seq = seq;
+    s.ms = seq * POWER_SAMPLE_INTERVAL_MS;
+    s.voltage = 12.0f + (seq % 7) * 0.004f;
+    s.current = 1500.0f + (seq % 13) * 0.1f;
+    s.power = s.voltage * s.current;
+    s.energy = seq * 0.0012f;
+    s.flags = 0;
+    return s;
+}
+
+void runCodecBenchmarks(Bench& bench, BenchSink sink, void* context) {
+    PowerSample sample = benchSample(1234);
+    char json[SNAPSHOT_BUFFER_SIZE];
+    uint8_t packed[SNAPSHOT_BUFFER_SIZE];
+
+    sink(bench.run("snapshot.json", [&]() {
+        benchSideEffect = SnapshotCache::encodeJson(sample, json, sizeof(json));
+    }, 200), context);
+
+    sink(bench.run("snapshot.msgpack", [&]() {
+        MsgPackWriter writer(packed, sizeof(packed));
+        writeSnapshotMsgPack(writer, sample);
+        benchSideEffect = writer.length();
+    }, 200), context);
+
+    // 每次序号不同，两种格式都重新序列化
+    SnapshotCache* cache = new SnapshotCache();
+    uint32_t seq = 1;
+    sink(bench.run("snapshot.update", [&]() {
+        sample.seq = seq++;
+        cache->update(sample);
+        benchSideEffect = cache->length(SnapshotCache::FORMAT_WEB);
+    }, 100), context);
+    delete cache;
+
+    // 交替小幅和大幅变化，上报与跳过两条路径各占一半
+    Deadband deadband;
+    const float absolute[Deadband::QUANTITY_COUNT] = {0.05f, 5.0f, 50.0f};
+    const float relative[Deadband::QUANTITY_COUNT] = {0.01f, 0.02f, 0.02f};
+    deadband.configure(absolute, relative, 60000);
+    PowerExtremes extremes;
+    uint32_t step = 0;
+    sink(bench.run("deadband.filter", [&]() {
+        PowerSample s = benchSample(step);
+        if (step++ & 1) s.current += 500;
+        benchSideEffect = deadband.filter(s, extremes);
+    }, 500), context);
+
+    PowerSample* batch = new PowerSample[BENCH_BATCH_SAMPLES];
+    PowerExtremes* batchExtremes = new PowerExtremes[BENCH_BATCH_SAMPLES];
+    char* payload = new char[TELEMETRY_PAYLOAD_SIZE];
+    for (size_t i = 0; i < BENCH_BATCH_SAMPLES; i++) {
+        batch[i] = benchSample(100 + i);
+        PowerExtremes& e = batchExtremes[i];
+        e.minVoltage = batch[i].voltage - 0.01f;
+        e.maxVoltage = batch[i].voltage + 0.01f;
+        e.minCurrent = batch[i].current - 3;
+        e.maxCurrent = batch[i].current + 3;
+        e.minPower = batch[i].power - 40;
+        e.maxPower = batch[i].power + 40;
+    }
+
+    sink(bench.run("mqtt.batch.json", [&]() {
+        benchSideEffect = encodeBatchJson(batch, nullptr, BENCH_BATCH_SAMPLES, 1700000000UL, 30000,
+                                          payload, TELEMETRY_PAYLOAD_SIZE);
+    }, 10), context);
+
+    sink(bench.run("mqtt.batch.msgpack", [&]() {
+        benchSideEffect = encodeBatchMsgPack(batch, nullptr, BENCH_BATCH_SAMPLES, 1700000000UL, 30000,
+                                             (uint8_t*)payload, TELEMETRY_PAYLOAD_SIZE);
+    }, 20), context);
+
+    sink(bench.run("mqtt.batch.extremes", [&]() {
+        benchSideEffect = encodeBatchMsgPack(batch, batchExtremes, BENCH_BATCH_SAMPLES, 1700000000UL, 30000,
+                                             (uint8_t*)payload, TELEMETRY_PAYLOAD_SIZE);
+    }, 20), context);
+
+    delete[] payload;
+    delete[] batchExtremes;
+    delete[] batch;
+}
+
+void runHistoryBenchmarks(Bench& bench, const PowerMonitor& monitor, BenchSink sink, void* context) {
+    PowerSample out[20];
+
+    sink(bench.run("history.latest", [&]() {
+        benchSideEffect = monitor.getLatest(out[0]);
+    }, 500), context);
+
+    sink(bench.run("history.since20", [&]() {
+        uint32_t latest = monitor.getLatestSeq();
+        benchSideEffect = monitor.getSamplesSince(latest > 20 ? latest - 20 : 0, out, 20);
+    }, 200), context);
+
+    sink(bench.run("history.count", [&]() {
+        benchSideEffect = monitor.getCountSince(0);
+    }, 500), context);
+}
+
+void runSensorBenchmarks(Bench& bench, I2cPort& port, BenchSink sink, void* context) {
+    static const uint32_t clocks[] = {100000, 400000};
+    static const char* const readNames[] = {"ina219.read@100k", "ina219.read@400k"};
+    static const char* const sampleNames[] = {"ina219.sample@100k", "ina219.sample@400k"};
+
+    for (size_t c = 0; c < sizeof(clocks) / sizeof(clocks[0]); c++) {
+        Wire.setClock(clocks[c]);
+        uint8_t reg = INA219_REG_BUSVOLTAGE;
+        uint8_t rx[2];
+        sink(bench.run(readNames[c], [&]() {
+            benchSideEffect = port.transfer(-1, INA219_ADDRESS, &reg, 1, rx, 2);
+        }, 20), context);
+
+        // 与 PowerMonitor 的一次采样相同的四次传输
+        uint8_t calibration[3] = {INA219_REG_CALIBRATION, POWER_CAL_VALUE >> 8, POWER_CAL_VALUE & 0xFF};
+        static const uint8_t registers[] = {INA219_REG_CURRENT, INA219_REG_BUSVOLTAGE, INA219_REG_POWER};
+        sink(bench.run(sampleNames[c], [&]() {
+            bool ok = port.transfer(-1, INA219_ADDRESS, calibration, 3, nullptr, 0);
+            for (size_t i = 0; i < 3; i++) {
+                ok = port.transfer(-1, INA219_ADDRESS, &registers[i], 1, rx, 2) && ok;
+            }
+            benchSideEffect = ok;
+        }, 10), context);
+    }
+    Wire.setClock(I2C_CLOCK_HZ);
+}
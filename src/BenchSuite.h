@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Bench.h"
+#include "I2cEngine.h"
+#include "PowerMonitor.h"
+
+// 每个用例完成后调用一次，由调用方负责输出（HTTP 分块、串口或主机上的表格/JSON）
+typedef void (*BenchSink)(const BenchResult& result, void* context);
+
+// 设备与主机共用的热点用例。用例名固定，设备上的 /bench 与主机上的 bench 结果可直接对比
+
+// 纯 CPU：快照 JSON/MessagePack 序列化、快照缓存更新、死区滤波、MQTT 批量负载
+void runCodecBenchmarks(Bench& bench, BenchSink sink, void* context);
+
+// 历史缓冲查询：最新样本、最近20个样本、计数
+void runHistoryBenchmarks(Bench& bench, const PowerMonitor& monitor, BenchSink sink, void* context);
+
+// INA219 寄存器读取和一次完整采样（写校准 + 电流、电压、功率），分别在100kHz和400kHz下
+// 同步执行，结束后恢复 I2C_CLOCK_HZ。传输不计入设备统计（设备编号为-1）
+void runSensorBenchmarks(Bench& bench, I2cPort& port, BenchSink sink, void* context);
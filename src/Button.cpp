@@ -0,0 +1,114 @@
+#include "Button.h"
+
+Button* Button::instance = nullptr;
+
+Button::Button(uint8_t pin)
+    : pin(pin), edgeHead(0), edgeTail(0), overflows(0),
+      rawLevel(HIGH), rawChangeMs(0), stableLevel(HIGH),
+      state(IDLE), stateMs(0), eventCount(0) {
+}
+
+void Button::begin() {
+    pinMode(pin, INPUT_PULLUP);
+    rawLevel = stableLevel = digitalRead(pin);
+    instance = this;
+    attachInterrupt(digitalPinToInterrupt(pin), onEdge, CHANGE);
+}
+
+void IRAM_ATTR Button::onEdge() {
+    Button* b = instance;
+    uint8_t next = (b->edgeHead + 1) % BUTTON_EDGE_QUEUE;
+    if (next == b->edgeTail) {
+        // 队列满时丢弃，update() 仍会按引脚当前电平纠正
+        b->overflows++;
+        return;
+    }
+    b->edges[b->edgeHead].ms = millis();
+    b->edges[b->edgeHead].level = digitalRead(b->pin);
+    b->edgeHead = next;
+}
+
+void Button::update() {
+    // 取出中断记录的边沿，只保留最后一次变化
+    while (edgeTail != edgeHead) {
+        uint8_t level = edges[edgeTail].level;
+        uint32_t ms = edges[edgeTail].ms;
+        edgeTail = (edgeTail + 1) % BUTTON_EDGE_QUEUE;
+        if (level != rawLevel) {
+            rawLevel = level;
+            rawChangeMs = ms;
+        }
+    }
+    // 丢失边沿时以引脚当前电平为准
+    if (overflows > 0) {
+        overflows = 0;
+        uint8_t level = digitalRead(pin);
+        if (level != rawLevel) {
+            rawLevel = level;
+            rawChangeMs = millis();
+        }
+    }
+
+    uint32_t now = millis();
+    // 电平保持稳定超过去抖时间才算一次真正的变化
+    if (rawLevel != stableLevel && now - rawChangeMs >= BUTTON_DEBOUNCE_MS) {
+        stableLevel = rawLevel;
+        onStableChange(stableLevel, rawChangeMs);
+    }
+
+    // 超时类手势
+    if (state == PRESSED && now - stateMs >= BUTTON_LONG_PRESS_MS) {
+        emit(BUTTON_LONG);
+        state = WAIT_RELEASE;
+    } else if (state == WAIT_SECOND && now - stateMs >= BUTTON_DOUBLE_GAP_MS) {
+        emit(BUTTON_SHORT);
+        state = IDLE;
+    }
+}
+
+void Button::onStableChange(uint8_t level, uint32_t ms) {
+    bool pressed = level == LOW;
+    switch (state) {
+        case IDLE:
+            if (pressed) {
+                state = PRESSED;
+                stateMs = ms;
+            }
+            break;
+        case PRESSED:
+            if (!pressed) {
+                state = WAIT_SECOND;
+                stateMs = ms;
+            }
+            break;
+        case WAIT_SECOND:
+            if (pressed) {
+                state = SECOND_PRESSED;
+                stateMs = ms;
+            }
+            break;
+        case SECOND_PRESSED:
+            if (!pressed) {
+                emit(BUTTON_DOUBLE);
+                state = IDLE;
+            }
+            break;
+        case WAIT_RELEASE:
+            if (!pressed) state = IDLE;
+            break;
+    }
+}
+
+void Button::emit(ButtonEvent event) {
+    if (eventCount < BUTTON_EVENT_QUEUE) {
+        events[eventCount++] = event;
+    }
+}
+
+bool Button::getEvent(ButtonEvent& event) {
+    if (eventCount == 0) return false;
+    event = events[0];
+    for (uint8_t i = 1; i < eventCount; i++) events[i - 1] = events[i];
+    eventCount--;
+    return true;
+}
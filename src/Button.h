@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Arduino.h>
+
+// 中断中缓存的边沿数，update() 每10ms取一次，足够容纳按键抖动
+#define BUTTON_EDGE_QUEUE 16
+#define BUTTON_EVENT_QUEUE 4
+
+#define BUTTON_DEBOUNCE_MS 30
+#define BUTTON_LONG_PRESS_MS 3000
+#define BUTTON_DOUBLE_GAP_MS 350
+
+enum ButtonEvent {
+    BUTTON_NONE = 0,
+    BUTTON_SHORT,       // 单击
+    BUTTON_DOUBLE,      // 双击
+    BUTTON_LONG         // 长按，按住达到3秒时立即触发，不等松开
+};
+
+// 低电平有效的按键。GPIO中断只记录边沿的时间和电平，
+// 去抖和手势识别在 update() 中完成，全程不阻塞
+class Button {
+public:
+    explicit Button(uint8_t pin);
+
+    void begin();
+
+    // 在主循环中周期调用，处理中断记录的边沿并识别手势
+    void update();
+
+    // 取出一个手势事件，没有时返回false
+    bool getEvent(ButtonEvent& event);
+
+private:
+    enum State {
+        IDLE,           // 松开
+        PRESSED,        // 第一次按下
+        WAIT_SECOND,    // 单击后等待第二次按下
+        SECOND_PRESSED, // 第二次按下
+        WAIT_RELEASE    // 已触发长按，等待松开
+    };
+
+    struct Edge {
+        uint32_t ms;
+        uint8_t level;
+    };
+
+    uint8_t pin;
+
+    // 中断写入，update() 读取；头尾指针各自只由一方修改
+    static Button* instance;
+    volatile Edge edges[BUTTON_EDGE_QUEUE];
+    volatile uint8_t edgeHead;
+    volatile uint8_t edgeTail;
+    volatile uint32_t overflows;
+
+    // 去抖
+    uint8_t rawLevel;
+    uint32_t rawChangeMs;
+    uint8_t stableLevel;
+
+    // 手势
+    State state;
+    uint32_t stateMs;
+
+    ButtonEvent events[BUTTON_EVENT_QUEUE];
+    uint8_t eventCount;
+
+    static void IRAM_ATTR onEdge();
+    void onStableChange(uint8_t level, uint32_t ms);
+    void emit(ButtonEvent event);
+};
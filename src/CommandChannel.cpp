@@ -0,0 +1,140 @@
+#include "CommandChannel.h"
+#include <time.h>
+#include "PowerCodec.h"
+
+CommandChannel::CommandChannel(PubSubClient& mqtt, PowerMonitor& monitor, VoltageCtl& voltageCtl)
+    : mqtt(mqtt), monitor(monitor), voltageCtl(voltageCtl), commandCount(0), errorCount(0) {
+}
+
+void CommandChannel::begin(const Config& config) {
+    commandTopic = config.Topic + "/cmd";
+    responseTopic = config.Topic + "/rsp";
+}
+
+// 写出带引号的 JSON 字符串，转义引号、反斜杠和控制字符，返回写入的长度。
+// out 至少要有 strlen(s) * 6 + 3 字节
+static int writeJsonString(char* out, const char* s) {
+    int len = 0;
+    out[len++] = '"';
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            out[len++] = '\\';
+            out[len++] = c;
+        } else if (c < 0x20) {
+            len += sprintf(out + len, "\\u%04x", c);
+        } else {
+            out[len++] = c;
+        }
+    }
+    out[len++] = '"';
+    out[len] = '\0';
+    return len;
+}
+
+bool CommandChannel::handle(const char* topic, uint8_t* payload, unsigned int length) {
+    if (commandTopic != topic) return false;
+    commandCount++;
+
+    // 传入可写的 char* 时 ArduinoJson 原地解析，字符串直接指向负载缓冲
+    StaticJsonDocument<256> request;
+    DeserializationError error = deserializeJson(request, (char*)payload, length);
+
+    // 先写出 id，应答前负载缓冲不会被覆盖。最长 COMMAND_ID_MAX 字节，转义后不超过 6 倍
+    int len = snprintf(response, sizeof(response), "{\"id\":");
+    JsonVariantConst id = request["id"];
+    if (id.is<const char*>() && strlen(id.as<const char*>()) <= COMMAND_ID_MAX) {
+        len += writeJsonString(response + len, id.as<const char*>());
+    } else if (id.is<long>()) {
+        len += snprintf(response + len, sizeof(response) - len, "%ld", id.as<long>());
+    } else {
+        len += snprintf(response + len, sizeof(response) - len, "null");
+    }
+
+    if (error) {
+        replyError(len, "bad request");
+        return true;
+    }
+
+    const char* cmd = request["cmd"] | "";
+    int result;
+    if (strcmp(cmd, "set_voltage") == 0) {
+        result = setVoltage(request, len);
+    } else if (strcmp(cmd, "snapshot") == 0) {
+        result = snapshot(len);
+    } else if (strcmp(cmd, "history") == 0) {
+        result = historySince(request, len);
+    } else if (strcmp(cmd, "energy_reset") == 0) {
+        result = resetEnergy(len);
+    } else {
+        replyError(len, "unknown command");
+        return true;
+    }
+
+    if (result < 0 || result >= (int)sizeof(response) - 1) {
+        replyError(len, result == -1 ? "invalid argument" : "response too large");
+        return true;
+    }
+    reply(result);
+    return true;
+}
+
+int CommandChannel::setVoltage(JsonVariantConst request, int len) {
+    int volts = request["volts"] | 0;
+    if (!voltageCtl.setTargetVolts(volts)) return -1;
+    return len + snprintf(response + len, sizeof(response) - len,
+                          ",\"ok\":true,\"voltage\":%d", voltageCtl.getTargetVolts());
+}
+
+int CommandChannel::snapshot(int len) {
+    PowerSample s;
+    if (!monitor.getLatest(s)) {
+        return len + snprintf(response + len, sizeof(response) - len,
+                              ",\"ok\":true,\"seq\":0,\"voltage\":%d", voltageCtl.getTargetVolts());
+    }
+    return len + snprintf(response + len, sizeof(response) - len,
+                          ",\"ok\":true,\"seq\":%lu,\"ms\":%lu,\"now\":%lu,"
+                          "\"power\":{\"voltage\":%.3f,\"current\":%.1f,\"power\":%.0f,\"mwh\":%.3f},"
+                          "\"flags\":%u,\"voltage\":%d,\"settling\":%s",
+                          (unsigned long)s.seq, (unsigned long)s.ms, millis(),
+                          s.voltage, s.current, s.power, s.energy, s.flags,
+                          voltageCtl.getTargetVolts(), voltageCtl.isSettling() ? "true" : "false");
+}
+
+// 返回序号大于 seq 的样本，"batch" 与遥测批量消息格式相同；
+// 样本多于 COMMAND_HISTORY_MAX 时 "more" 为 true，以 batch.seq 继续请求
+int CommandChannel::historySince(JsonVariantConst request, int len) {
+    uint32_t seq = request["seq"] | 0UL;
+    size_t count = monitor.getSamplesSince(seq, history, COMMAND_HISTORY_MAX);
+    if (count == 0) {
+        return len + snprintf(response + len, sizeof(response) - len,
+                              ",\"ok\":true,\"seq\":%lu,\"oldest\":%lu,\"batch\":null",
+                              (unsigned long)monitor.getLatestSeq(), (unsigned long)monitor.getOldestSeq());
+    }
+    len += snprintf(response + len, sizeof(response) - len,
+                    ",\"ok\":true,\"seq\":%lu,\"oldest\":%lu,\"more\":%s,\"batch\":",
+                    (unsigned long)monitor.getLatestSeq(), (unsigned long)monitor.getOldestSeq(),
+                    history[count - 1].seq < monitor.getLatestSeq() ? "true" : "false");
+    if (len >= (int)sizeof(response)) return -2;
+    size_t batch = encodeBatchJson(history, nullptr, count, time(nullptr), millis(),
+                                   response + len, sizeof(response) - len);
+    if (batch == 0) return -2;
+    return len + batch;
+}
+
+int CommandChannel::resetEnergy(int len) {
+    float previous = monitor.resetEnergy();
+    return len + snprintf(response + len, sizeof(response) - len,
+                          ",\"ok\":true,\"mwh\":%.3f", previous);
+}
+
+void CommandChannel::reply(int len) {
+    len += snprintf(response + len, sizeof(response) - len, "}");
+    mqtt.publish(responseTopic.c_str(), (const uint8_t*)response, len);
+}
+
+void CommandChannel::replyError(int len, const char* error) {
+    errorCount++;
+    len += snprintf(response + len, sizeof(response) - len, ",\"ok\":false,\"error\":\"%s\"", error);
+    reply(len);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include "EspSmartWifi.h"
+#include "PowerMonitor.h"
+#include "VoltageCtl.h"
+
+// 命令响应缓冲，需小于 MQTT 缓冲区（2048字节）减去主题和报头
+#define COMMAND_RESPONSE_SIZE 1600
+// history 命令单次最多返回的样本数
+#define COMMAND_HISTORY_MAX 24
+// 字符串 id 的最大字节数，更长的 id 不截断，应答中为 null
+#define COMMAND_ID_MAX 32
+
+// MQTT命令通道：订阅 <topic>/cmd，应答发布到 <topic>/rsp。
+// 请求为 JSON：{"id":"a1","cmd":"set_voltage","volts":12}，
+// 应答原样带回 id：{"id":"a1","ok":true,...}，失败时 {"id":"a1","ok":false,"error":"..."}。
+// 支持的命令：set_voltage、snapshot、history（"seq":N）、energy_reset。
+// 请求在 PubSubClient 的接收缓冲中原地解析（ArduinoJson 零拷贝模式），不复制负载。
+class CommandChannel {
+public:
+    CommandChannel(PubSubClient& mqtt, PowerMonitor& monitor, VoltageCtl& voltageCtl);
+
+    void begin(const Config& config);
+
+    const String& getCommandTopic() const { return commandTopic; }
+
+    // 在 MQTT 回调中调用，不是命令主题时返回false
+    bool handle(const char* topic, uint8_t* payload, unsigned int length);
+
+    uint32_t getCommandCount() const { return commandCount; }
+    uint32_t getErrorCount() const { return errorCount; }
+
+private:
+    PubSubClient& mqtt;
+    PowerMonitor& monitor;
+    VoltageCtl& voltageCtl;
+    String commandTopic;
+    String responseTopic;
+    uint32_t commandCount;
+    uint32_t errorCount;
+
+    char response[COMMAND_RESPONSE_SIZE];
+    PowerSample history[COMMAND_HISTORY_MAX];
+
+    // 以下函数在 response 中 "ok":true 之后追加字段，返回新的长度，失败时返回-1
+    int setVoltage(JsonVariantConst request, int len);
+    int snapshot(int len);
+    int historySince(JsonVariantConst request, int len);
+    int resetEnergy(int len);
+
+    void reply(int len);
+    void replyError(int len, const char* error);
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "PowerSample.h"
+
+// 按变化上报（report-by-exception）：只有电压、电流或功率相对上次上报值的变化
+// 超过死区时才上报样本。死区取 max(绝对死区, 相对死区 * |上次上报值|)。
+// 心跳周期内没有上报时强制上报一次，保证接收方能确认设备在线；
+// 被跳过样本的最小/最大值随下一个上报样本一起输出。
+class Deadband {
+public:
+    enum Quantity {
+        VOLTAGE = 0,    // V
+        CURRENT,        // mA
+        POWER,          // mW
+        QUANTITY_COUNT
+    };
+
+    Deadband() : heartbeat(0), hasLast(false), hasRange(false) {
+        for (int q = 0; q < QUANTITY_COUNT; q++) {
+            absolute[q] = 0;
+            relative[q] = 0;
+        }
+    }
+
+    // heartbeat 为0时关闭死区，每个样本都上报
+    void configure(const float abs[QUANTITY_COUNT], const float rel[QUANTITY_COUNT], unsigned long heartbeat) {
+        for (int q = 0; q < QUANTITY_COUNT; q++) {
+            absolute[q] = abs[q];
+            relative[q] = rel[q];
+        }
+        this->heartbeat = heartbeat;
+        hasLast = false;
+        hasRange = false;
+    }
+
+    bool isEnabled() const { return heartbeat > 0; }
+
+    // 需要上报时返回true，并在 extremes 中给出自上次上报以来（含本样本）的极值
+    bool filter(const PowerSample& sample, PowerExtremes& extremes) {
+        float values[QUANTITY_COUNT] = {sample.voltage, sample.current, sample.power};
+        accumulate(values);
+
+        if (isEnabled() && hasLast && sample.ms - lastMs < heartbeat && !exceeds(values)) {
+            return false;
+        }
+
+        extremes.minVoltage = rangeMin[VOLTAGE];
+        extremes.maxVoltage = rangeMax[VOLTAGE];
+        extremes.minCurrent = rangeMin[CURRENT];
+        extremes.maxCurrent = rangeMax[CURRENT];
+        extremes.minPower = rangeMin[POWER];
+        extremes.maxPower = rangeMax[POWER];
+
+        for (int q = 0; q < QUANTITY_COUNT; q++) last[q] = values[q];
+        lastMs = sample.ms;
+        hasLast = true;
+        hasRange = false;
+        return true;
+    }
+
+private:
+    float absolute[QUANTITY_COUNT];
+    float relative[QUANTITY_COUNT];
+    unsigned long heartbeat;
+
+    bool hasLast;
+    float last[QUANTITY_COUNT];     // 上次上报的值
+    uint32_t lastMs;
+
+    bool hasRange;
+    float rangeMin[QUANTITY_COUNT];
+    float rangeMax[QUANTITY_COUNT];
+
+    void accumulate(const float values[QUANTITY_COUNT]) {
+        for (int q = 0; q < QUANTITY_COUNT; q++) {
+            if (!hasRange || values[q] < rangeMin[q]) rangeMin[q] = values[q];
+            if (!hasRange || values[q] > rangeMax[q]) rangeMax[q] = values[q];
+        }
+        hasRange = true;
+    }
+
+    bool exceeds(const float values[QUANTITY_COUNT]) const {
+        for (int q = 0; q < QUANTITY_COUNT; q++) {
+            float reference = last[q] < 0 ? -last[q] : last[q];
+            float threshold = relative[q] * reference;
+            if (threshold < absolute[q]) threshold = absolute[q];
+            float delta = values[q] - last[q];
+            if (delta < 0) delta = -delta;
+            if (delta > threshold) return true;
+        }
+        return false;
+    }
+};
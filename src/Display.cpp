@@ -2,9 +2,6 @@
 #include "EspSmartWifi.h"
 #include "PowerMonitor.h"
 
-extern EspSmartWifi wifi;
-extern PowerMonitor powerMonitor;
-
 // 缓存继电器状态
 static bool cachedRelayStates[4] = {false, false, false, false};
 
@@ -43,17 +40,79 @@ void Display::displayPowerInfo() {
     display.setTextSize(1);
     display.println(F("Power Monitor:"));
     
-    for (int ch = 0; ch < 1; ch++) {
-        float voltage = powerMonitor.getBusVoltage_V();
-        float current = powerMonitor.getCurrent_mA();
-        
-        display.print(F("CH"));
-        display.print(ch + 1);
-        display.print(F(": "));
-        display.print(voltage, 1);
+    // 使用最近一次采样，不再单独占用I2C总线读取传感器
+    PowerSample sample;
+    if (powerMonitor.getLatest(sample)) {
+        display.print(F("CH1: "));
+        display.print(sample.voltage, 1);
         display.print(F("V "));
-        display.print(current, 0);
+        display.print(sample.current, 0);
         display.println(F("mA"));
     }
 }
 
+
+
+// 逐页（8行为一页）比较帧缓冲与上一帧，每页只发送首尾变化列之间的区域。
+// 为传感器让出总线时停止，未发送的部分仍与上一帧不同，下次刷新继续发送
+void Display::flush() {
+    const uint8_t* buffer = display.getBuffer();
+    bool changed = false;
+    for (uint8_t page = 0; page < SCREEN_HEIGHT / 8; page++) {
+        const uint8_t* row = buffer + page * SCREEN_WIDTH;
+        const uint8_t* old = shadow + page * SCREEN_WIDTH;
+        int first = -1;
+        int last = -1;
+        for (int col = 0; col < SCREEN_WIDTH; col++) {
+            if (row[col] != old[col]) {
+                if (first < 0) first = col;
+                last = col;
+            }
+        }
+        if (first < 0) continue;
+        changed = true;
+        if (!sendRange(page, first, last)) break;
+    }
+    if (changed) flushCount++;
+}
+
+// 发送一页中的一段列，每块传输后更新上一帧副本，总线需要让给传感器或传输失败时返回false
+bool Display::sendRange(uint8_t page, uint8_t startCol, uint8_t endCol) {
+    if (!bus->mayTransfer(busDevice, DISPLAY_FLUSH_CHUNK + 7)) return false;
+
+    // 水平寻址模式下设置页、列窗口后连续写入数据
+    bus->start();
+    Wire.beginTransmission(SCREEN_ADDRESS);
+    Wire.write((uint8_t)0x00);  // 控制字节：后续为命令
+    Wire.write((uint8_t)SSD1306_PAGEADDR);
+    Wire.write(page);
+    Wire.write(page);
+    Wire.write((uint8_t)SSD1306_COLUMNADDR);
+    Wire.write(startCol);
+    Wire.write(endCol);
+    bool ok = Wire.endTransmission() == 0;
+    bus->finish(busDevice, 7, ok);
+    if (!ok) return false;
+
+    const uint8_t* data = display.getBuffer() + page * SCREEN_WIDTH;
+    uint8_t* old = shadow + page * SCREEN_WIDTH;
+    uint8_t col = startCol;
+    while (col <= endCol) {
+        uint8_t n = endCol - col + 1;
+        if (n > DISPLAY_FLUSH_CHUNK) n = DISPLAY_FLUSH_CHUNK;
+        // 列窗口已设置，中途让出后下次重新设置窗口
+        if (col != startCol && !bus->mayTransfer(busDevice, n + 1)) return false;
+        bus->start();
+        Wire.beginTransmission(SCREEN_ADDRESS);
+        Wire.write((uint8_t)0x40);  // 控制字节：后续为显示数据
+        Wire.write(data + col, n);
+        ok = Wire.endTransmission() == 0;
+        bus->finish(busDevice, n + 1, ok);
+        // 失败的块不更新上一帧副本，下次刷新重发
+        if (!ok) return false;
+        memcpy(old + col, data + col, n);
+        flushBytes += n;
+        col += n;
+    }
+    return true;
+}
@@ -4,28 +4,56 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include "I2cBus.h"
 
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 32
 #define OLED_RESET -1
 #define SCREEN_ADDRESS 0x3C
 
+// 刷新与翻页周期：数值按 5Hz 刷新，每3秒切换页面
+#define DISPLAY_REFRESH_MS 200
+#define DISPLAY_PAGE_MS 3000
+// 每次I2C传输的最大数据字节数（另加1个控制字节），不超过Wire的32字节缓冲
+#define DISPLAY_FLUSH_CHUNK 31
+#define DISPLAY_BUFFER_SIZE (SCREEN_WIDTH * SCREEN_HEIGHT / 8)
+
+class EspSmartWifi;
+class PowerMonitor;
+
 class Display {
 private:
     Adafruit_SSD1306 display;
+    EspSmartWifi& wifi;
+    PowerMonitor& powerMonitor;
+    I2cBus* bus = nullptr;
+    int busDevice = -1;
     unsigned long lastUpdate = 0;
+    unsigned long lastPageSwitch = 0;
     int currentPage = 0;
     const int totalPages = 2; // WiFi状态、电源信息
 
+    // 上一次已发送到屏幕的帧，用于找出变化的区域
+    uint8_t shadow[DISPLAY_BUFFER_SIZE];
+    uint32_t flushCount = 0;
+    uint32_t flushBytes = 0;
+
     void displayWiFiStatus();
     void displayRelayStatus();
     void displayPowerInfo();
+    bool sendRange(uint8_t page, uint8_t startCol, uint8_t endCol);
 
 public:
-    Display() : display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET) {}
+    // 传输期间和传输之后都保持总线时钟，库默认会在每次传输后降回100kHz
+    Display(EspSmartWifi& wifi, PowerMonitor& powerMonitor)
+        : display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET, I2C_CLOCK_HZ, I2C_CLOCK_HZ),
+          wifi(wifi), powerMonitor(powerMonitor) {}
 
-    bool begin() {
-        if(!display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS)) {
+    // 总线由 I2cBus 初始化，库不再调用 Wire.begin()
+    bool begin(I2cBus& i2c) {
+        bus = &i2c;
+        busDevice = bus->addDevice("ssd1306", SCREEN_ADDRESS);
+        if(!display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS, true, false)) {
             Serial.println(F("SSD1306 allocation failed"));
             return false;
         }
@@ -36,28 +64,49 @@ public:
         display.setCursor(0,0);
         display.println(F("Initializing..."));
         display.display();
+        memcpy(shadow, display.getBuffer(), DISPLAY_BUFFER_SIZE);
         return true;
     }
 
+    // 每次重绘整页到帧缓冲，但只把与上一帧不同的部分发送到屏幕
     void update() {
-        if (millis() - lastUpdate >= 3000) { // 每3秒切换一次显示页面
-            lastUpdate = millis();
+        unsigned long now = millis();
+        if (now - lastUpdate < DISPLAY_REFRESH_MS) return;
+        lastUpdate = now;
+        if (now - lastPageSwitch >= DISPLAY_PAGE_MS) {
+            lastPageSwitch = now;
             currentPage = (currentPage + 1) % totalPages;
-            
-            display.clearDisplay();
-            display.setCursor(0,0);
-            
-            switch(currentPage) {
-                case 0:
-                    displayWiFiStatus();
-                    break;
-                case 1:
-                    displayPowerInfo();
-                    break;
-            }
-            
-            display.display();
+        }
+
+        render();
+        flush();
+    }
+
+    // 把当前页绘制到帧缓冲，不发送到屏幕
+    void render() {
+        display.clearDisplay();
+        display.setCursor(0,0);
+
+        switch(currentPage) {
+            case 0:
+                displayWiFiStatus();
+                break;
+            case 1:
+                displayPowerInfo();
+                break;
         }
     }
 
+    // 把帧缓冲中与上一帧不同的部分发送到屏幕
+    void flush();
+
+    // 使上一帧副本失效，下次 flush() 发送整帧
+    void invalidate() {
+        const uint8_t* buffer = display.getBuffer();
+        for (size_t i = 0; i < DISPLAY_BUFFER_SIZE; i++) shadow[i] = ~buffer[i];
+    }
+
+    uint32_t getFlushCount() const { return flushCount; }   // 实际发生传输的刷新次数
+    uint32_t getFlushBytes() const { return flushBytes; }   // 累计发送的显示数据字节
+
 }; 
\ No newline at end of file
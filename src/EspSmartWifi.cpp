@@ -3,6 +3,9 @@
 #include <EasyLed.h>
 #include <FS.h>
 #include "EspSmartWifi.h"
+#include "LedPattern.h"
+#include "HeapMonitor.h"
+#include "Log.h"
 #include "WebServer.h"  // 添加头文件以使用引脚定义
 
 void reset() 
@@ -12,6 +15,8 @@ void reset()
     while (1) {}
 }
 
+static const char* const DEADBAND_KEYS[3] = {"voltage", "current", "power"};
+
 bool EspSmartWifi::LoadConfig()
 {
     Serial.println("\n=== Loading WiFi Configuration ===");
@@ -28,7 +33,7 @@ bool EspSmartWifi::LoadConfig()
     }
     Serial.println("Config file opened successfully");
 
-    StaticJsonDocument<512> doc;
+    StaticJsonDocument<768> doc;
     DeserializationError error = deserializeJson(doc, configFile);
     configFile.close();
 
@@ -43,6 +48,19 @@ bool EspSmartWifi::LoadConfig()
     _config.Passwd = doc["passwd"] | "1";
     _config.Server = doc["server"] | "192.1.8.3";
     _config.Topic = doc["topic"] | "/espRouterPower/power";
+    _config.BatchSize = doc["batch_size"] | 20;
+    _config.BatchLatency = doc["batch_latency"] | 5000;
+    _config.Encoding = doc["encoding"] | "json";
+    _config.Heartbeat = doc["heartbeat"] | 0;
+    _config.QueueSpill = doc["queue_spill"] | false;
+    _config.LogMqtt = doc["log_mqtt"] | false;
+    // 死区格式："deadband": {"voltage": [绝对, 相对], "current": [...], "power": [...]}
+    Config defaults;
+    for (int q = 0; q < 3; q++) {
+        JsonArray band = doc["deadband"][DEADBAND_KEYS[q]];
+        _config.DeadbandAbs[q] = band[0] | defaults.DeadbandAbs[q];
+        _config.DeadbandRel[q] = band[1] | defaults.DeadbandRel[q];
+    }
     _config.bConfigValid = true;
 
     Serial.println("WiFi configuration loaded successfully");
@@ -60,11 +78,23 @@ bool EspSmartWifi::SaveConfig(Config config)
 bool EspSmartWifi::SaveConfig()
 {
     Serial.println("\n=== Saving WiFi Configuration ===");
-    StaticJsonDocument<512> doc;
+    StaticJsonDocument<768> doc;
     doc["ssid"] = _config.SSID;
     doc["passwd"] = _config.Passwd;
     doc["server"] = _config.Server;
     doc["topic"] = _config.Topic;
+    doc["batch_size"] = _config.BatchSize;
+    doc["batch_latency"] = _config.BatchLatency;
+    doc["encoding"] = _config.Encoding;
+    doc["heartbeat"] = _config.Heartbeat;
+    doc["queue_spill"] = _config.QueueSpill;
+    doc["log_mqtt"] = _config.LogMqtt;
+    JsonObject deadband = doc.createNestedObject("deadband");
+    for (int q = 0; q < 3; q++) {
+        JsonArray band = deadband.createNestedArray(DEADBAND_KEYS[q]);
+        band.add(_config.DeadbandAbs[q]);
+        band.add(_config.DeadbandRel[q]);
+    }
 
     File configFile = SPIFFS.open("/config.json", "w");
     if (!configFile) {
@@ -103,53 +133,58 @@ void EspSmartWifi::BaseConfig()
         Serial.println("\nWiFi connected");
         Serial.print("IP address: ");
         Serial.println(WiFi.localIP());
-        led_.flash(3, 100, 100, 0, 0);  // 快速闪烁3次表示连接成功
+        flashLed(3, 100, 100);  // 快速闪烁3次表示连接成功
     } else {
         Serial.println("\nWiFi connection failed, will retry...");
-        led_.flash(1, 1000, 1000, 0, 0);  // 慢闪表示等待重连
+        flashLed(1, 1000, 1000);  // 慢闪表示等待重连
+    }
+}
+
+// 状态提示：运行期交给图案播放器按活动优先级播放，不阻塞主循环
+void EspSmartWifi::flashLed(uint8_t count, uint16_t onMs, uint16_t offMs)
+{
+    if (pattern_ != nullptr) {
+        LedPattern pattern = {1, onMs, offMs, count};
+        pattern_->play(PATTERN_ACTIVITY, pattern);
+    } else {
+        led_.flash(count, onMs, offMs, 0, 0);
     }
 }
 
 void EspSmartWifi::StartAPMode()
 {
     if (_isAPMode) {
-        Serial_debug.println("Already in AP mode, skipping initialization");
+        LOG_DEBUG("Already in AP mode, skipping initialization");
         return;
     }
-
-    Serial_debug.println("Starting AP mode...");
     
     // 创建唯一的AP名称
+    HeapMonitor::Scope heap(HEAP_SITE_WIFI_AP);
     String apName = "ESP_Config_" + String(ESP.getChipId(), HEX);
     
     // 配置AP模式
     WiFi.mode(WIFI_AP);
     WiFi.softAP(apName.c_str(), "12345678", 6);  // 使用固定的密码
+    // apName 与协议栈的 AP 配置此时同时占用，记为峰值
+    heap.mark();
     
-    Serial_debug.print("AP started with SSID: ");
-    Serial_debug.println(apName);
-    Serial_debug.print("AP IP address: ");
-    Serial_debug.println(WiFi.softAPIP());
+    LOG_INFO("AP started: %s at %s", apName.c_str(), WiFi.softAPIP().toString().c_str());
     
     _isAPMode = true;
-    led_.flash(2, 100, 100, 0, 0);  // 慢闪表示AP模式
+    flashLed(2, 100, 100);  // 慢闪表示AP模式
 }
 
 void EspSmartWifi::StopAPMode() {
     if (!_isAPMode) return;
-    Serial_debug.println("Stopping AP mode, switching to STA mode...");
+    LOG_INFO("Stopping AP mode, switching to STA mode");
     WiFi.softAPdisconnect(true);
     WiFi.mode(WIFI_STA);
     _isAPMode = false;
-    led_.flash(1, 100, 100, 0, 0); // 快闪表示退出AP
+    flashLed(1, 100, 100); // 快闪表示退出AP
 }
 
 void EspSmartWifi::TryConnectWifi() {
-    Serial_debug.println("Trying to connect to WiFi...");
-    Serial_debug.print("SSID: ");
-    Serial_debug.println(_config.SSID);
-    Serial_debug.print("Password: ");
-    Serial_debug.println(_config.Passwd);
+    LOG_INFO("Trying to connect to WiFi %s", _config.SSID.c_str());
     
     WiFi.mode(WIFI_STA);
     WiFi.begin(_config.SSID.c_str(), _config.Passwd.c_str());
@@ -184,8 +219,8 @@ bool EspSmartWifi::WiFiWatchDog()
     if (WiFi.status() != WL_CONNECTED) {
         if (!_isAPMode && _config.bConfigValid)
         {
-            Serial.println("WiFi disconnected, attempting to reconnect...");
-            led_.flash(1, 100, 100, 0, 0);  // 慢闪表示等待重连
+            LOG_WARN("WiFi disconnected, attempting to reconnect");
+            flashLed(1, 100, 100);  // 慢闪表示等待重连
             WiFi.begin(_config.SSID.c_str(), _config.Passwd.c_str());
         }
 
@@ -205,7 +240,7 @@ bool EspSmartWifi::WiFiWatchDog()
         if (_isAPMode) {
             StopAPMode();
         }
-        led_.flash(1, 100, 100, 0, 0);  // 快闪表示已连接
+        flashLed(1, 100, 100);  // 快闪表示已连接
         apModeActive = false;
         lastModeSwitchMillis = now;
     }
@@ -215,58 +250,58 @@ bool EspSmartWifi::WiFiWatchDog()
 
 void EspSmartWifi::initFS()
 {
-    Serial_debug.println("\n=== Initializing SPIFFS ===");
+    Serial.println("\n=== Initializing SPIFFS ===");
     
     // 检查文件系统信息
     FSInfo fs_info;
     if (SPIFFS.info(fs_info)) {
-        Serial_debug.print("Total bytes: ");
-        Serial_debug.println(fs_info.totalBytes);
-        Serial_debug.print("Used bytes: ");
-        Serial_debug.println(fs_info.usedBytes);
+        Serial.print("Total bytes: ");
+        Serial.println(fs_info.totalBytes);
+        Serial.print("Used bytes: ");
+        Serial.println(fs_info.usedBytes);
     } else {
-        Serial_debug.println("Failed to get filesystem info, attempting to format...");
+        Serial.println("Failed to get filesystem info, attempting to format...");
         if (SPIFFS.format()) {
-            Serial_debug.println("Filesystem formatted successfully");
+            Serial.println("Filesystem formatted successfully");
         } else {
-            Serial_debug.println("Failed to format filesystem");
+            Serial.println("Failed to format filesystem");
             return;
         }
     }
     
-    Serial_debug.println("\nMounting SPIFFS...");
+    Serial.println("\nMounting SPIFFS...");
     if (!SPIFFS.begin()) {
-        Serial_debug.println("Failed to mount SPIFFS, attempting to format...");
+        Serial.println("Failed to mount SPIFFS, attempting to format...");
         if (SPIFFS.format()) {
-            Serial_debug.println("Filesystem formatted successfully");
+            Serial.println("Filesystem formatted successfully");
             if (!SPIFFS.begin()) {
-                Serial_debug.println("Failed to mount SPIFFS after format");
+                Serial.println("Failed to mount SPIFFS after format");
                 return;
             }
         } else {
-            Serial_debug.println("Failed to format filesystem");
+            Serial.println("Failed to format filesystem");
             return;
         }
     }
     
     // 列出文件系统中的所有文件
-    Serial_debug.println("\nFiles in SPIFFS:");
+    Serial.println("\nFiles in SPIFFS:");
     Dir dir = SPIFFS.openDir("/");
     bool hasFiles = false;
     while (dir.next()) {
         hasFiles = true;
-        Serial_debug.print("  ");
-        Serial_debug.print(dir.fileName());
-        Serial_debug.print("  ");
-        Serial_debug.print(dir.fileSize());
-        Serial_debug.println(" bytes");
+        Serial.print("  ");
+        Serial.print(dir.fileName());
+        Serial.print("  ");
+        Serial.print(dir.fileSize());
+        Serial.println(" bytes");
     }
     if (!hasFiles) {
-        Serial_debug.println("  No files found");
+        Serial.println("  No files found");
     }
     
-    Serial_debug.println("\nSPIFFS mounted successfully");
-    Serial_debug.println("=== SPIFFS Initialization Complete ===\n");
+    Serial.println("\nSPIFFS mounted successfully");
+    Serial.println("=== SPIFFS Initialization Complete ===\n");
 }
 
 void EspSmartWifi::DisplayIP()
@@ -276,13 +311,13 @@ void EspSmartWifi::DisplayIP()
 
 String EspSmartWifi::httpGet(const String& path) {
     if (WiFi.status() != WL_CONNECTED) {
-        Serial_debug.println("WiFi not connected");
+        LOG_DEBUG("HTTP GET skipped: WiFi not connected");
         return "";
     }
 
+    HeapMonitor::Scope heap(HEAP_SITE_HTTP_GET);
     String url = _config.Server + path + "?icon=https://support.arduino.cc/hc/article_attachments/12416033021852.png";
-    Serial_debug.print("HTTP GET: ");
-    Serial_debug.println(url);
+    LOG_DEBUG("HTTP GET %s", path.c_str());
 
     HTTPClient http;
     http.begin(client, url);
@@ -292,12 +327,13 @@ String EspSmartWifi::httpGet(const String& path) {
     if (httpCode > 0) {
         if (httpCode == HTTP_CODE_OK) {
             payload = http.getString();
-            Serial_debug.println("HTTP Response: " + payload);
+            heap.mark();
+            LOG_DEBUG("HTTP GET %s: %u bytes", path.c_str(), payload.length());
         } else {
-            Serial_debug.printf("HTTP GET failed, error: %s\n", http.errorToString(httpCode).c_str());
+            LOG_WARN("HTTP GET %s failed: status %d", path.c_str(), httpCode);
         }
     } else {
-        Serial_debug.printf("HTTP GET failed, error: %s\n", http.errorToString(httpCode).c_str());
+        LOG_WARN("HTTP GET %s failed: %s", path.c_str(), http.errorToString(httpCode).c_str());
     }
 
     http.end();
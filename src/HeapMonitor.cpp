@@ -0,0 +1,73 @@
+#include "HeapMonitor.h"
+#include "Log.h"
+
+uint32_t HeapMonitor::freeBytes = 0;
+uint32_t HeapMonitor::maxBlock = 0;
+uint8_t HeapMonitor::fragmentation = 0;
+uint32_t HeapMonitor::minFree = 0xFFFFFFFF;
+uint32_t HeapMonitor::minMaxBlock = 0xFFFFFFFF;
+uint8_t HeapMonitor::maxFragmentation = 0;
+uint32_t HeapMonitor::lowEvents = 0;
+bool HeapMonitor::low = false;
+HeapSiteStats HeapMonitor::sites[HEAP_SITE_COUNT];
+
+static const char* const SITE_NAMES[HEAP_SITE_COUNT] = {
+    "wifi_ap", "url_parse", "mqtt_rx", "http_get"
+};
+
+const char* HeapMonitor::siteName(HeapSite site) {
+    return site < HEAP_SITE_COUNT ? SITE_NAMES[site] : "unknown";
+}
+
+void HeapMonitor::read() {
+    // 一次调用取得三项，彼此一致
+    uint32_t free = 0;
+    uint32_t block = 0;
+    uint8_t frag = 0;
+    ESP.getHeapStats(&free, &block, &frag);
+    freeBytes = free;
+    maxBlock = block;
+    fragmentation = frag;
+    if (freeBytes < minFree) minFree = freeBytes;
+    if (maxBlock < minMaxBlock) minMaxBlock = maxBlock;
+    if (fragmentation > maxFragmentation) maxFragmentation = fragmentation;
+}
+
+void HeapMonitor::sample() {
+    read();
+    if (!low) {
+        if (freeBytes < HEAP_LOW_FREE_BYTES || maxBlock < HEAP_LOW_BLOCK_BYTES ||
+            fragmentation > HEAP_HIGH_FRAGMENTATION) {
+            low = true;
+            lowEvents++;
+            LOG_WARN("Heap low: free %lu, max block %lu, fragmentation %u%%",
+                     (unsigned long)freeBytes, (unsigned long)maxBlock, (unsigned)fragmentation);
+        }
+        return;
+    }
+    if (freeBytes > HEAP_LOW_FREE_BYTES * (100 + HEAP_RECOVER_PERCENT) / 100 &&
+        maxBlock > HEAP_LOW_BLOCK_BYTES * (100 + HEAP_RECOVER_PERCENT) / 100 &&
+        fragmentation < HEAP_HIGH_FRAGMENTATION * (100 - HEAP_RECOVER_PERCENT) / 100) {
+        low = false;
+        LOG_INFO("Heap recovered: free %lu, max block %lu, fragmentation %u%%",
+                 (unsigned long)freeBytes, (unsigned long)maxBlock, (unsigned)fragmentation);
+    }
+}
+
+HeapMonitor::Scope::Scope(HeapSite site) : site(site) {
+    sites[site].calls++;
+    freeAtEntry = ESP.getFreeHeap();
+}
+
+HeapMonitor::Scope::~Scope() {
+    // 作用域内其他模块（WiFi 协议栈）的分配也会计入，残留值是上界
+    read();
+    if (freeBytes < freeAtEntry) sites[site].retainedBytes += freeAtEntry - freeBytes;
+}
+
+void HeapMonitor::Scope::mark() {
+    read();
+    if (freeBytes < freeAtEntry && freeAtEntry - freeBytes > sites[site].peakBytes) {
+        sites[site].peakBytes = freeAtEntry - freeBytes;
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Arduino.h>
+
+// 告警阈值：可用堆、最大连续块低于阈值或碎片率高于阈值时记录一条警告。
+// 各项回到阈值之外 HEAP_RECOVER_PERCENT% 才记录恢复，避免在阈值附近反复告警
+#define HEAP_LOW_FREE_BYTES 8192
+#define HEAP_LOW_BLOCK_BYTES 4096
+#define HEAP_HIGH_FRAGMENTATION 50
+#define HEAP_RECOVER_PERCENT 25
+#define HEAP_SAMPLE_MS 1000
+
+// 主要的 String 分配点
+enum HeapSite {
+    HEAP_SITE_WIFI_AP = 0,      // AP 名称
+    HEAP_SITE_URL_PARSE,        // MQTT 服务器地址解析的 substring
+    HEAP_SITE_MQTT_RX,          // MQTT 消息回调
+    HEAP_SITE_HTTP_GET,         // httpGet 的 URL 和应答
+    HEAP_SITE_COUNT
+};
+
+struct HeapSiteStats {
+    uint32_t calls;
+    uint32_t peakBytes;         // 作用域内相对进入时的最大占用
+    uint32_t retainedBytes;     // 离开作用域后仍未归还的累计字节，持续增长说明有泄漏或长期占用
+};
+
+// 堆状态跟踪：周期记录可用堆、最大连续块和碎片率及其历史最差值，越过阈值时写日志；
+// 各分配点用 Scope 包围，按分配点统计调用次数、峰值占用和残留。
+// ESP8266 的堆只有约40KB，长时间运行后碎片使最大连续块远小于可用堆，
+// 大块 String 会先于可用堆耗尽而分配失败。只在主循环中使用
+class HeapMonitor {
+public:
+    class Scope {
+    public:
+        explicit Scope(HeapSite site);
+        ~Scope();
+
+        // 记录当前占用，在数据构造完成、释放之前调用
+        void mark();
+
+    private:
+        HeapSite site;
+        uint32_t freeAtEntry;
+    };
+
+    // 周期调用，更新当前值、历史最差值，越过阈值时写日志
+    static void sample();
+
+    static uint32_t getFree() { return freeBytes; }
+    static uint32_t getMaxBlock() { return maxBlock; }
+    static uint8_t getFragmentation() { return fragmentation; }
+    // 启动以来的最差值
+    static uint32_t getMinFree() { return minFree; }
+    static uint32_t getMinMaxBlock() { return minMaxBlock; }
+    static uint8_t getMaxFragmentation() { return maxFragmentation; }
+    // 进入低内存状态的次数
+    static uint32_t getLowEvents() { return lowEvents; }
+    static bool isLow() { return low; }
+
+    static const char* siteName(HeapSite site);
+    static const HeapSiteStats& getSite(HeapSite site) { return sites[site]; }
+
+private:
+    static uint32_t freeBytes;
+    static uint32_t maxBlock;
+    static uint8_t fragmentation;
+    static uint32_t minFree;
+    static uint32_t minMaxBlock;
+    static uint8_t maxFragmentation;
+    static uint32_t lowEvents;
+    static bool low;
+    static HeapSiteStats sites[HEAP_SITE_COUNT];
+
+    // 读取当前值并更新最差值
+    static void read();
+};
@@ -0,0 +1,120 @@
+#include "I2cBus.h"
+#include "Log.h"
+
+int I2cBus::addDevice(const char* name, uint8_t address) {
+    if (deviceCount >= I2C_MAX_DEVICES) {
+        LOG_ERROR("I2C device table full, %s not added", name);
+        return -1;
+    }
+    I2cDevice& dev = devices[deviceCount];
+    dev.name = name;
+    dev.address = address;
+    dev.transactions = 0;
+    dev.bytes = 0;
+    dev.deferred = 0;
+    dev.errors = 0;
+    dev.retries = 0;
+    return deviceCount++;
+}
+
+void I2cBus::start() {
+    startCycles = ESP.getCycleCount();
+}
+
+void I2cBus::finish(int device, size_t bytes, bool ok) {
+    uint32_t cycles = ESP.getCycleCount() - startCycles;
+    if (device < 0 || (size_t)device >= deviceCount) return;
+
+    I2cDevice& dev = devices[device];
+    dev.transactions++;
+    if (ok) {
+        dev.bytes += bytes;
+    } else {
+        dev.errors++;
+    }
+    dev.latency.record(cycles);
+    windowBusyUs += cycles / LatencyStats::cyclesPerMicro();
+
+    unsigned long now = millis();
+    if (now - windowStart >= LATENCY_WINDOW_MS) roll(now);
+}
+
+void I2cBus::recordRetry(int device) {
+    if (device >= 0 && (size_t)device < deviceCount) devices[device].retries++;
+}
+
+// 开漏输出：拉低时输出低电平，释放时切回上拉输入
+static void releaseLine(uint8_t pin) {
+    pinMode(pin, INPUT_PULLUP);
+    delayMicroseconds(5);
+}
+
+static void pullLine(uint8_t pin) {
+    digitalWrite(pin, LOW);
+    pinMode(pin, OUTPUT);
+    delayMicroseconds(5);
+}
+
+bool I2cBus::recover() {
+    recoveries++;
+    releaseLine(I2C_SDA_PIN);
+    releaseLine(I2C_SCL_PIN);
+    int clocks = 0;
+    while (clocks < 9 && digitalRead(I2C_SDA_PIN) == LOW) {
+        pullLine(I2C_SCL_PIN);
+        releaseLine(I2C_SCL_PIN);
+        clocks++;
+    }
+    // STOP：SCL为高时SDA由低变高
+    pullLine(I2C_SDA_PIN);
+    releaseLine(I2C_SCL_PIN);
+    releaseLine(I2C_SDA_PIN);
+    bool released = digitalRead(I2C_SDA_PIN) == HIGH && digitalRead(I2C_SCL_PIN) == HIGH;
+
+    begin();
+    if (released) {
+        LOG_WARN("I2C bus recovered after %d clocks", clocks);
+    } else {
+        LOG_ERROR("I2C bus still held low after recovery");
+    }
+    return released;
+}
+
+bool I2cBus::mayTransfer(int device, size_t bytes) {
+    if (engine != nullptr && engine->pending() > 0) {
+        if (device >= 0 && (size_t)device < deviceCount) devices[device].deferred++;
+        return false;
+    }
+    if (!reserved) return true;
+    long remainingMs = (long)(reservedAt - millis());
+    // 每字节9个时钟（含ACK），另加地址字节和起止条件的余量
+    uint32_t estimateUs = (uint32_t)((bytes + 2) * 9 * 1000000ULL / I2C_CLOCK_HZ);
+    if (remainingMs >= 0 && (uint32_t)remainingMs * 1000 > estimateUs) return true;
+    if (remainingMs < -I2C_RESERVE_STALE_MS) return true;
+    // 传感器已到期或来不及在预约时间之前完成：让出总线，调度器会先运行传感器任务
+    if (device >= 0 && (size_t)device < deviceCount) devices[device].deferred++;
+    return false;
+}
+
+void I2cBus::roll(unsigned long now) {
+    unsigned long elapsedMs = now - windowStart;
+    utilization = elapsedMs > 0 ? (uint16_t)((uint64_t)windowBusyUs / elapsedMs) : 0;
+    if (utilization > 1000) utilization = 1000;
+    windowStart = now;
+    windowBusyUs = 0;
+    for (size_t i = 0; i < deviceCount; i++) devices[i].latency.roll();
+}
+
+bool WirePort::transfer(int device, uint8_t address, const uint8_t* tx, size_t txLen,
+                        uint8_t* rx, size_t rxLen) {
+    bus.start();
+    Wire.beginTransmission(address);
+    Wire.write(tx, txLen);
+    bool ok = Wire.endTransmission() == 0;
+    if (ok && rxLen > 0) {
+        ok = Wire.requestFrom(address, (uint8_t)rxLen) == rxLen;
+        for (size_t i = 0; ok && i < rxLen; i++) rx[i] = Wire.read();
+    }
+    bus.finish(device, txLen + rxLen, ok);
+    return ok;
+}
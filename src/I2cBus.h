@@ -0,0 +1,109 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "LatencyStats.h"
+#include "I2cEngine.h"
+
+// 总线时钟：INA219 与 SSD1306 都支持 400kHz 快速模式
+#define I2C_CLOCK_HZ 400000
+#define I2C_MAX_DEVICES 4
+// 预约时间过去这么久仍未执行，视为预约失效（设备停止工作），不再阻止其他传输
+#define I2C_RESERVE_STALE_MS 50
+// 总线引脚，恢复总线时直接操作
+#ifndef I2C_SDA_PIN
+#define I2C_SDA_PIN SDA
+#endif
+#ifndef I2C_SCL_PIN
+#define I2C_SCL_PIN SCL
+#endif
+
+// 单个设备的传输统计，耗时包括等待从机的时间
+struct I2cDevice {
+    const char* name;
+    uint8_t address;
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t deferred;      // 为保证高优先级传输而推迟的次数
+    uint32_t errors;        // 失败的传输（NACK、超时、总线被占用）
+    uint32_t retries;       // 失败后重试的次数
+    LatencyStats latency;
+};
+
+// I2C 总线管理：统一初始化 Wire 和时钟，统计各设备的传输次数、字节数和耗时。
+// 主循环是协作式的，传输之间不会互相打断；需要准时的设备（传感器）用 reserve()
+// 预告下一次传输的时间，可拆分的大块传输（显示刷新）每块之前调用 mayTransfer()，
+// 来不及在预约时间之前完成就停下，剩余部分下次再发，保证传感器读取不被推迟。
+class I2cBus {
+public:
+    I2cBus() : deviceCount(0), reservedAt(0), reserved(false), engine(nullptr), startCycles(0),
+               windowStart(0), windowBusyUs(0), utilization(0), recoveries(0) {}
+
+    void begin() {
+        Wire.begin();
+        Wire.setClock(I2C_CLOCK_HZ);
+    }
+
+    // 部分驱动在初始化时会重新调用 Wire.begin()，恢复默认时钟；设备初始化完成后调用
+    void restoreClock() {
+        Wire.setClock(I2C_CLOCK_HZ);
+    }
+
+    // 登记设备，返回设备编号，已满时返回-1
+    int addDevice(const char* name, uint8_t address);
+
+    // 包围一次传输（可以包含多个 Wire 事务），bytes 为读写的数据字节数，ok 为传输是否成功
+    void start();
+    void finish(int device, size_t bytes, bool ok = true);
+    void recordRetry(int device);
+
+    // 从机在传输中途复位或被干扰时可能一直拉低SDA：手动输出最多9个SCL时钟
+    // 让它送完当前字节，再发STOP并重新初始化 Wire。返回总线是否已释放
+    bool recover();
+
+    // 预告下一次高优先级传输的时间（millis）
+    void reserve(unsigned long at) {
+        reservedAt = at;
+        reserved = true;
+    }
+
+    // 按当前时钟估算传输 bytes 字节所需时间后，判断能否在预约时间之前完成；
+    // 引擎中还有排队的传感器传输时同样让出。不能传输时计入该设备的推迟次数
+    bool mayTransfer(int device, size_t bytes);
+
+    // 排队传输引擎，其中的请求优先于可拆分的大块传输
+    void setEngine(const I2cEngine* queued) { engine = queued; }
+
+    size_t getDeviceCount() const { return deviceCount; }
+    const I2cDevice& getDevice(size_t index) const { return devices[index]; }
+    // 上一个统计窗口内总线被占用的时间比例（千分比）
+    uint16_t getUtilization() const { return utilization; }
+    uint32_t getRecoveries() const { return recoveries; }
+
+private:
+    I2cDevice devices[I2C_MAX_DEVICES];
+    size_t deviceCount;
+    unsigned long reservedAt;
+    bool reserved;
+    const I2cEngine* engine;
+    uint32_t startCycles;
+    unsigned long windowStart;
+    uint32_t windowBusyUs;
+    uint16_t utilization;
+    uint32_t recoveries;
+
+    void roll(unsigned long now);
+};
+
+// 通过 Wire 执行引擎的请求，并把每次传输计入 I2cBus 的设备统计
+class WirePort : public I2cPort {
+public:
+    explicit WirePort(I2cBus& bus) : bus(bus) {}
+
+    bool transfer(int device, uint8_t address, const uint8_t* tx, size_t txLen,
+                  uint8_t* rx, size_t rxLen) override;
+    void retried(int device) override { bus.recordRetry(device); }
+
+private:
+    I2cBus& bus;
+};
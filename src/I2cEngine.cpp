@@ -0,0 +1,74 @@
+#include "I2cEngine.h"
+#include <string.h>
+
+bool I2cEngine::submit(const I2cRequest& request) {
+    if (count >= I2C_QUEUE_SIZE || request.txLen > I2C_REQUEST_MAX_TX || request.rxLen > I2C_REQUEST_MAX_RX) {
+        return false;
+    }
+    I2cRequest& slot = queue[(head + count) % I2C_QUEUE_SIZE];
+    slot = request;
+    slot.attempts = 0;
+    slot.ok = false;
+    count++;
+    return true;
+}
+
+bool I2cEngine::readRegister16(int device, uint8_t address, uint8_t reg, uint8_t retries,
+                               I2cCallback callback, void* context) {
+    I2cRequest request;
+    memset(&request, 0, sizeof(request));
+    request.device = device;
+    request.address = address;
+    request.tx[0] = reg;
+    request.txLen = 1;
+    request.rxLen = 2;
+    request.retries = retries;
+    request.callback = callback;
+    request.context = context;
+    return submit(request);
+}
+
+bool I2cEngine::writeRegister16(int device, uint8_t address, uint8_t reg, uint16_t value, uint8_t retries,
+                                I2cCallback callback, void* context) {
+    I2cRequest request;
+    memset(&request, 0, sizeof(request));
+    request.device = device;
+    request.address = address;
+    request.tx[0] = reg;
+    request.tx[1] = value >> 8;
+    request.tx[2] = value & 0xFF;
+    request.txLen = 3;
+    request.rxLen = 0;
+    request.retries = retries;
+    request.callback = callback;
+    request.context = context;
+    return submit(request);
+}
+
+bool I2cEngine::poll() {
+    if (count == 0) return false;
+
+    I2cRequest& request = queue[head];
+    request.attempts++;
+    request.ok = port.transfer(request.device, request.address, request.tx, request.txLen,
+                               request.rx, request.rxLen);
+    if (!request.ok && request.retries > 0) {
+        // 留在队首，下次 poll() 重试
+        request.retries--;
+        retriedCount++;
+        port.retried(request.device);
+        return true;
+    }
+
+    // 先出队再回调，回调中可以继续提交请求
+    I2cRequest done = request;
+    head = (head + 1) % I2C_QUEUE_SIZE;
+    count--;
+    if (done.ok) {
+        completed++;
+    } else {
+        failed++;
+    }
+    if (done.callback) done.callback(done, done.context);
+    return true;
+}
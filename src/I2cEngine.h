@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 排队的传输个数，每个设备同一时刻通常只有一个请求在队列中
+#define I2C_QUEUE_SIZE 8
+#define I2C_REQUEST_MAX_TX 4
+#define I2C_REQUEST_MAX_RX 4
+
+// 实际执行传输的端口。设备上由 Wire 实现，主机测试中由模拟总线实现
+class I2cPort {
+public:
+    virtual ~I2cPort() {}
+    // 写出 tx 后读回 rxLen 字节（rxLen 为0时只写），返回是否成功
+    virtual bool transfer(int device, uint8_t address, const uint8_t* tx, size_t txLen,
+                          uint8_t* rx, size_t rxLen) = 0;
+    // 传输失败、即将重试时调用，供统计
+    virtual void retried(int /*device*/) {}
+};
+
+struct I2cRequest;
+typedef void (*I2cCallback)(const I2cRequest& request, void* context);
+
+// 一次寄存器读或写。完成（成功或重试用尽）后调用 callback，
+// 回调中可以提交下一个请求，从而把多步操作串成状态机
+struct I2cRequest {
+    int device;             // I2cBus 中的设备编号，用于统计
+    uint8_t address;
+    uint8_t tx[I2C_REQUEST_MAX_TX];
+    uint8_t txLen;
+    uint8_t rx[I2C_REQUEST_MAX_RX];
+    uint8_t rxLen;
+    uint8_t retries;        // 失败后还可重试的次数
+    uint8_t attempts;       // 已执行的次数
+    bool ok;
+    I2cCallback callback;
+    void* context;
+
+    // 按大端读出的16位寄存器值
+    uint16_t value16() const { return ((uint16_t)rx[0] << 8) | rx[1]; }
+};
+
+// 排队的 I2C 传输引擎：提交请求只是入队，poll() 每次只执行一个传输（失败时的一次重试
+// 也算一次），由调度器周期调用。一组多寄存器的读取因此分散到多次调度之间，
+// 其他任务可以在两次传输之间运行，单次 poll() 的耗时以一个寄存器传输为上限。
+// 不依赖 Arduino，主机测试可直接使用
+class I2cEngine {
+public:
+    explicit I2cEngine(I2cPort& port)
+        : port(port), head(0), count(0), completed(0), failed(0), retriedCount(0) {}
+
+    // 入队，队列已满时返回false
+    bool submit(const I2cRequest& request);
+
+    // 读16位寄存器：写寄存器地址后读2字节
+    bool readRegister16(int device, uint8_t address, uint8_t reg, uint8_t retries,
+                        I2cCallback callback, void* context);
+    // 写16位寄存器：寄存器地址后跟大端的2字节
+    bool writeRegister16(int device, uint8_t address, uint8_t reg, uint16_t value, uint8_t retries,
+                         I2cCallback callback, void* context);
+
+    // 执行队首的一个传输，队列为空时返回false
+    bool poll();
+
+    size_t pending() const { return count; }
+    uint32_t getCompleted() const { return completed; }
+    uint32_t getFailed() const { return failed; }
+    uint32_t getRetried() const { return retriedCount; }
+
+private:
+    I2cPort& port;
+    I2cRequest queue[I2C_QUEUE_SIZE];
+    size_t head;
+    size_t count;
+    uint32_t completed;
+    uint32_t failed;
+    uint32_t retriedCount;
+};
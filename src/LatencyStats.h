@@ -0,0 +1,104 @@
+#pragma once
+
+#include <Arduino.h>
+
+// 直方图桶数：0~3μs 各一个桶，之后每个2的幂区间分两个桶，最后一个桶约覆盖1秒以上
+#define LATENCY_BUCKETS 40
+// 滚动统计窗口
+#define LATENCY_WINDOW_MS 10000
+
+// 耗时统计：记录 CPU 周期数（ESP.getCycleCount() 之差），按窗口给出平均、最大和 p99。
+// record() 只做几次整数运算，开销相对被测任务可以忽略；
+// p99 取直方图桶的上界，误差不超过实际值的一半（2的幂区间分两个桶）。
+class LatencyStats {
+public:
+    LatencyStats() : lifetimeMax(0) {
+        resetWindow();
+        lastCount = 0;
+        lastMean = 0;
+        lastMax = 0;
+        lastP99 = 0;
+    }
+
+    void record(uint32_t cycles) {
+        uint32_t us = cycles / cyclesPerMicro();
+        count++;
+        sum += us;
+        if (us > max) max = us;
+        if (us > lifetimeMax) lifetimeMax = us;
+        uint16_t& bucket = histogram[bucketOf(us)];
+        if (bucket < 0xFFFF) bucket++;
+    }
+
+    // 结束当前窗口，结果在下一个窗口结束前可读
+    void roll() {
+        lastCount = count;
+        lastMean = count > 0 ? (uint32_t)(sum / count) : 0;
+        lastMax = max;
+        lastP99 = percentile(99);
+        resetWindow();
+    }
+
+    // 上一个完整窗口的统计（μs）
+    uint32_t getCount() const { return lastCount; }
+    uint32_t getMean() const { return lastMean; }
+    uint32_t getMax() const { return lastMax; }
+    uint32_t getP99() const { return lastP99; }
+    // 启动以来的最大值（μs）
+    uint32_t getLifetimeMax() const { return lifetimeMax; }
+
+    static uint32_t cyclesPerMicro() {
+        return ESP.getCpuFreqMHz();
+    }
+
+private:
+    uint32_t count;
+    uint64_t sum;
+    uint32_t max;
+    uint16_t histogram[LATENCY_BUCKETS];
+
+    uint32_t lastCount;
+    uint32_t lastMean;
+    uint32_t lastMax;
+    uint32_t lastP99;
+    uint32_t lifetimeMax;
+
+    void resetWindow() {
+        count = 0;
+        sum = 0;
+        max = 0;
+        memset(histogram, 0, sizeof(histogram));
+    }
+
+    static size_t bucketOf(uint32_t us) {
+        if (us < 4) return us;
+        int octave = 31 - __builtin_clz(us);
+        size_t index = 4 + (octave - 2) * 2 + ((us >> (octave - 1)) & 1);
+        return index < LATENCY_BUCKETS ? index : LATENCY_BUCKETS - 1;
+    }
+
+    // 桶内最大可能值
+    static uint32_t bucketUpper(size_t index) {
+        if (index < 4) return index;
+        int octave = (index - 4) / 2 + 2;
+        uint32_t half = (index - 4) % 2;
+        return (1UL << octave) + ((half + 1) << (octave - 1)) - 1;
+    }
+
+    uint32_t percentile(uint32_t p) const {
+        if (count == 0) return 0;
+        uint32_t total = 0;
+        for (size_t i = 0; i < LATENCY_BUCKETS; i++) total += histogram[i];
+        uint32_t target = (total * p + 99) / 100;
+        uint32_t seen = 0;
+        for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+            seen += histogram[i];
+            if (seen >= target) {
+                if (i == LATENCY_BUCKETS - 1) return max;
+                uint32_t upper = bucketUpper(i);
+                return upper < max ? upper : max;
+            }
+        }
+        return max;
+    }
+};
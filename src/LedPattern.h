@@ -0,0 +1,100 @@
+#pragma once
+
+#include <Arduino.h>
+
+// 闪烁图案：color 为点亮时的颜色（状态LED只区分0和非0），
+// 亮 onMs 后灭 offMs，重复 count 次，count 为0时一直重复；offMs 为0时常亮
+struct LedPattern {
+    uint32_t color;
+    uint16_t onMs;
+    uint16_t offMs;
+    uint8_t count;
+
+    bool operator==(const LedPattern& other) const {
+        return color == other.color && onMs == other.onMs && offMs == other.offMs && count == other.count;
+    }
+};
+
+// 优先级：故障 > 一次性提示 > 活动提示 > 空闲指示。
+// 故障槽位由电压检查周期性启停，一次性提示（如清除配置）单独占一个槽位，不会被其取消
+enum PatternPriority {
+    PATTERN_IDLE = 0,
+    PATTERN_ACTIVITY,
+    PATTERN_NOTICE,
+    PATTERN_FAULT,
+    PATTERN_PRIORITIES
+};
+
+// 非阻塞图案播放器：每个优先级一个槽位，update() 按当前时间计算最高优先级图案的亮灭，
+// 只在输出变化时调用 output。由调度器周期调用，本身不做任何等待
+class PatternPlayer {
+public:
+    typedef void (*Output)(uint32_t color);  // color 为0表示熄灭
+
+    explicit PatternPlayer(Output output) : output(output), lastColor(0), dirty(true) {
+        for (int i = 0; i < PATTERN_PRIORITIES; i++) slots[i].active = false;
+    }
+
+    // 在指定优先级播放图案；与正在播放的图案相同时不重新开始，可以周期调用
+    void play(PatternPriority priority, const LedPattern& pattern) {
+        Slot& slot = slots[priority];
+        if (slot.active && slot.pattern == pattern) return;
+        slot.pattern = pattern;
+        slot.start = millis();
+        slot.active = true;
+    }
+
+    void stop(PatternPriority priority) {
+        slots[priority].active = false;
+    }
+
+    bool isPlaying(PatternPriority priority) const {
+        return slots[priority].active;
+    }
+
+    // 输出设备的状态被外部改变（如亮度）时调用，下次 update() 重新输出
+    void invalidate() {
+        dirty = true;
+    }
+
+    void update() {
+        uint32_t color = 0;
+        unsigned long now = millis();
+        for (int i = PATTERN_PRIORITIES - 1; i >= 0; i--) {
+            Slot& slot = slots[i];
+            if (!slot.active) continue;
+            const LedPattern& p = slot.pattern;
+            uint32_t cycle = (uint32_t)p.onMs + p.offMs;
+            uint32_t elapsed = now - slot.start;
+            if (cycle == 0 || p.offMs == 0) {
+                color = p.color;
+                break;
+            }
+            if (p.count > 0 && elapsed / cycle >= p.count) {
+                // 播放完毕，让给低优先级的图案
+                slot.active = false;
+                continue;
+            }
+            color = elapsed % cycle < p.onMs ? p.color : 0;
+            break;
+        }
+
+        if (color != lastColor || dirty) {
+            lastColor = color;
+            dirty = false;
+            output(color);
+        }
+    }
+
+private:
+    struct Slot {
+        LedPattern pattern;
+        unsigned long start;
+        bool active;
+    };
+
+    Output output;
+    Slot slots[PATTERN_PRIORITIES];
+    uint32_t lastColor;
+    bool dirty;
+};
@@ -0,0 +1,299 @@
+#include "Log.h"
+
+uint8_t Log::buffer[LOG_BUFFER_SIZE];
+size_t Log::head = 0;
+size_t Log::tail = 0;
+size_t Log::used = 0;
+uint32_t Log::firstSeq = 1;
+uint32_t Log::nextSeq = 1;
+uint8_t Log::runtimeLevel = LOG_LEVEL;
+uint32_t Log::dropped = 0;
+LogCursor Log::serialCursor = {1, 0};
+
+// 记录头：参数长度(1) + 级别(1) + millis(4) + 格式字符串地址
+static const size_t HEADER_SIZE = 2 + sizeof(uint32_t) + sizeof(PGM_P);
+
+static const char LEVEL_CHARS[] = "-EWID";
+
+// 串口输出中尚未写完的一行
+static char serialLine[LOG_LINE_SIZE + 16];
+static size_t serialLineLen = 0;
+static size_t serialLinePos = 0;
+
+void LogArgs::add(const char* v) {
+    if (v == nullptr) v = "(null)";
+    size_t n = strnlen(v, LOG_MAX_STRING);
+    if (!reserve(2)) return;
+    if (!reserve(2 + n)) n = LOG_MAX_ARG_BYTES - len - 2;
+    buf[len++] = ARG_STRING;
+    buf[len++] = n;
+    memcpy(buf + len, v, n);
+    len += n;
+}
+
+void LogArgs::addSigned(long v) {
+    // zigzag 编码，绝对值小的负数也只占一个字节
+    uint32_t zz = ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+    if (!reserve(6)) return;
+    buf[len++] = ARG_INT;
+    putVarint(zz);
+}
+
+void LogArgs::addUnsigned(unsigned long v) {
+    if (!reserve(6)) return;
+    buf[len++] = ARG_UINT;
+    putVarint(v);
+}
+
+void LogArgs::addFloat(float v) {
+    if (!reserve(5)) return;
+    buf[len++] = ARG_FLOAT;
+    memcpy(buf + len, &v, sizeof(v));
+    len += sizeof(v);
+}
+
+void LogArgs::putVarint(uint32_t v) {
+    while (v >= 0x80) {
+        buf[len++] = (v & 0x7F) | 0x80;
+        v >>= 7;
+    }
+    buf[len++] = v;
+}
+
+char Log::levelChar(uint8_t level) {
+    return level < sizeof(LEVEL_CHARS) - 1 ? LEVEL_CHARS[level] : '?';
+}
+
+void Log::copyIn(size_t offset, const void* data, size_t n) {
+    const uint8_t* src = (const uint8_t*)data;
+    for (size_t i = 0; i < n; i++) {
+        buffer[(offset + i) % LOG_BUFFER_SIZE] = src[i];
+    }
+}
+
+void Log::copyOut(size_t offset, void* data, size_t n) {
+    uint8_t* dst = (uint8_t*)data;
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = buffer[(offset + i) % LOG_BUFFER_SIZE];
+    }
+}
+
+size_t Log::recordSize(size_t offset) {
+    return HEADER_SIZE + buffer[offset];
+}
+
+void Log::evictOldest() {
+    // 串口还没输出的记录被覆盖，计入丢弃
+    if (serialCursor.seq <= firstSeq) {
+        dropped++;
+    }
+    size_t n = recordSize(tail);
+    tail = (tail + n) % LOG_BUFFER_SIZE;
+    used -= n;
+    firstSeq++;
+}
+
+void Log::append(uint8_t level, PGM_P format, const LogArgs& args) {
+    size_t n = HEADER_SIZE + args.length();
+    while (LOG_BUFFER_SIZE - used < n) {
+        evictOldest();
+    }
+
+    uint8_t header[HEADER_SIZE];
+    uint32_t ms = millis();
+    header[0] = args.length();
+    header[1] = level;
+    memcpy(header + 2, &ms, sizeof(ms));
+    memcpy(header + 2 + sizeof(ms), &format, sizeof(format));
+    copyIn(head, header, HEADER_SIZE);
+    copyIn(head + HEADER_SIZE, args.data(), args.length());
+    head = (head + n) % LOG_BUFFER_SIZE;
+    used += n;
+    nextSeq++;
+}
+
+void Log::seek(LogCursor& cursor, uint32_t since) {
+    cursor.seq = firstSeq;
+    cursor.offset = tail;
+    while (cursor.seq < nextSeq && cursor.seq <= since) {
+        cursor.offset = (cursor.offset + recordSize(cursor.offset)) % LOG_BUFFER_SIZE;
+        cursor.seq++;
+    }
+}
+
+bool Log::next(LogCursor& cursor, LogEntry& entry, char* text, size_t size) {
+    // 游标处的记录已被覆盖，或游标来自清空前的缓冲
+    if (cursor.seq < firstSeq || cursor.seq > nextSeq) {
+        cursor.seq = firstSeq;
+        cursor.offset = tail;
+    }
+    if (cursor.seq == nextSeq) return false;
+
+    uint8_t header[HEADER_SIZE];
+    copyOut(cursor.offset, header, HEADER_SIZE);
+    uint8_t argLen = header[0];
+    PGM_P fmt;
+    entry.seq = cursor.seq;
+    entry.level = header[1];
+    memcpy(&entry.ms, header + 2, sizeof(entry.ms));
+    memcpy(&fmt, header + 2 + sizeof(entry.ms), sizeof(fmt));
+
+    uint8_t args[LOG_MAX_ARG_BYTES];
+    copyOut(cursor.offset + HEADER_SIZE, args, argLen);
+    format(fmt, args, argLen, text, size);
+
+    cursor.offset = (cursor.offset + HEADER_SIZE + argLen) % LOG_BUFFER_SIZE;
+    cursor.seq++;
+    return true;
+}
+
+// 按格式字符串逐个取出捕获的参数，每个转换说明单独交给 snprintf。
+// 长度修饰符（l、h 等）被忽略，整数统一按 long 处理
+size_t Log::format(PGM_P fmt, const uint8_t* args, size_t argLen, char* out, size_t size) {
+    if (size == 0) return 0;
+    size_t len = 0;
+    size_t ai = 0;
+    PGM_P p = fmt;
+    char c;
+    while ((c = pgm_read_byte(p++)) != 0 && len + 1 < size) {
+        if (c != '%') {
+            out[len++] = c;
+            continue;
+        }
+
+        char spec[16];
+        size_t sl = 0;
+        spec[sl++] = '%';
+        c = pgm_read_byte(p++);
+        if (c == '%') {
+            out[len++] = '%';
+            continue;
+        }
+        while (c != 0 && strchr("-+ #0123456789.", c) != nullptr) {
+            if (sl < sizeof(spec) - 4) spec[sl++] = c;
+            c = pgm_read_byte(p++);
+        }
+        while (c == 'l' || c == 'h' || c == 'z' || c == 'j' || c == 't' || c == 'L') {
+            c = pgm_read_byte(p++);
+        }
+        if (c == 0) break;
+
+        // 取出下一个参数
+        uint8_t type = ai < argLen ? args[ai++] : 0;
+        long ival = 0;
+        float fval = 0;
+        char sval[LOG_MAX_STRING + 1] = "?";
+        if (type == LogArgs::ARG_INT || type == LogArgs::ARG_UINT) {
+            uint32_t v = 0;
+            int shift = 0;
+            while (ai < argLen) {
+                uint8_t b = args[ai++];
+                v |= (uint32_t)(b & 0x7F) << shift;
+                shift += 7;
+                if (!(b & 0x80)) break;
+            }
+            ival = type == LogArgs::ARG_INT ? (long)(int32_t)((v >> 1) ^ (0 - (v & 1))) : (long)v;
+            fval = type == LogArgs::ARG_INT ? (float)ival : (float)v;
+        } else if (type == LogArgs::ARG_FLOAT && ai + sizeof(float) <= argLen) {
+            memcpy(&fval, args + ai, sizeof(float));
+            ai += sizeof(float);
+            ival = (long)fval;
+        } else if (type == LogArgs::ARG_STRING && ai < argLen) {
+            size_t n = args[ai++];
+            if (n > argLen - ai) n = argLen - ai;
+            memcpy(sval, args + ai, n);
+            sval[n] = 0;
+            ai += n;
+        }
+
+        int n;
+        switch (c) {
+            case 'd': case 'i':
+                spec[sl++] = 'l';
+                spec[sl++] = 'd';
+                spec[sl] = 0;
+                n = snprintf(out + len, size - len, spec, ival);
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                spec[sl++] = 'l';
+                spec[sl++] = c;
+                spec[sl] = 0;
+                n = snprintf(out + len, size - len, spec, (unsigned long)ival);
+                break;
+            case 'c':
+                spec[sl++] = 'c';
+                spec[sl] = 0;
+                n = snprintf(out + len, size - len, spec, (int)ival);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+                spec[sl++] = c;
+                spec[sl] = 0;
+                n = snprintf(out + len, size - len, spec, (double)fval);
+                break;
+            case 's':
+                spec[sl++] = 's';
+                spec[sl] = 0;
+                n = snprintf(out + len, size - len, spec, sval);
+                break;
+            default:
+                n = snprintf(out + len, size - len, "%%%c", c);
+                break;
+        }
+        if (n > 0) len += (size_t)n < size - len ? (size_t)n : size - len - 1;
+    }
+    out[len] = 0;
+    return len;
+}
+
+size_t Log::toJson(const LogEntry& entry, const char* text, char* out, size_t size) {
+    int n = snprintf(out, size, "[%lu,%lu,\"%c\",\"", (unsigned long)entry.seq,
+                     (unsigned long)entry.ms, levelChar(entry.level));
+    if (n < 0 || (size_t)n >= size) return 0;
+    size_t len = n;
+    for (const char* p = text; *p; p++) {
+        // 转义后最长6字节，另留出结尾的 "] 两个字节
+        if (len + 8 >= size) return 0;
+        unsigned char ch = *p;
+        if (ch == '"' || ch == '\\') {
+            out[len++] = '\\';
+            out[len++] = ch;
+        } else if (ch < 0x20) {
+            len += snprintf(out + len, size - len, "\\u%04x", ch);
+        } else {
+            out[len++] = ch;
+        }
+    }
+    out[len++] = '"';
+    out[len++] = ']';
+    out[len] = 0;
+    return len;
+}
+
+void Log::drain() {
+    for (;;) {
+        if (serialLinePos == serialLineLen) {
+            // 上一行已写完，格式化下一条记录
+            LogEntry entry;
+            char text[LOG_LINE_SIZE];
+            if (!next(serialCursor, entry, text, sizeof(text))) return;
+            int n = snprintf(serialLine, sizeof(serialLine), "%lu %c %s\n",
+                             (unsigned long)entry.ms, levelChar(entry.level), text);
+            serialLineLen = n < (int)sizeof(serialLine) ? n : sizeof(serialLine) - 1;
+            serialLinePos = 0;
+        }
+        int room = Serial.availableForWrite();
+        if (room <= 0) return;
+        size_t chunk = serialLineLen - serialLinePos;
+        if (chunk > (size_t)room) chunk = room;
+        Serial.write((const uint8_t*)serialLine + serialLinePos, chunk);
+        serialLinePos += chunk;
+    }
+}
+
+void Log::flush() {
+    while (serialCursor.seq != nextSeq || serialLinePos != serialLineLen) {
+        drain();
+        yield();
+    }
+    Serial.flush();
+}
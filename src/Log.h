@@ -0,0 +1,180 @@
+#pragma once
+
+#include <Arduino.h>
+
+// 日志级别，低于编译期阈值 LOG_LEVEL 的日志调用整体编译掉（参数也不会求值）。
+// 在 platformio.ini 中通过 -DLOG_LEVEL=n 设置，默认只保留 INFO 及以上
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// 日志环形缓冲大小（字节）。记录为二进制格式，典型一条 12~20 字节，
+// 4KB 约可保存两三百条；满时覆盖最旧的记录
+#ifndef LOG_BUFFER_SIZE
+#define LOG_BUFFER_SIZE 4096
+#endif
+// 单条日志格式化后的最大长度，超出部分截断
+#define LOG_LINE_SIZE 128
+// 单条记录参数的最大字节数，字符串参数最多保存的字符数
+#define LOG_MAX_ARG_BYTES 64
+#define LOG_MAX_STRING 32
+
+// 格式字符串放在闪存中，记录里只保存其地址
+#define LOG_AT(level, fmt, ...) Log::write(level, PSTR(fmt), ##__VA_ARGS__)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(fmt, ...) LOG_AT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(fmt, ...) LOG_AT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(fmt, ...) LOG_AT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(fmt, ...) LOG_AT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(fmt, ...) do {} while (0)
+#endif
+
+// 调用时捕获的参数：每个参数一个类型字节，整数用变长编码，字符串复制内容
+class LogArgs {
+public:
+    enum Type {
+        ARG_INT = 1,    // zigzag 变长整数
+        ARG_UINT,       // 变长整数
+        ARG_FLOAT,      // 4字节 float
+        ARG_STRING      // 长度字节 + 内容
+    };
+
+    LogArgs() : len(0) {}
+
+    void add(int v) { addSigned(v); }
+    void add(long v) { addSigned(v); }
+    void add(short v) { addSigned(v); }
+    void add(signed char v) { addSigned(v); }
+    void add(unsigned int v) { addUnsigned(v); }
+    void add(unsigned long v) { addUnsigned(v); }
+    void add(unsigned short v) { addUnsigned(v); }
+    void add(unsigned char v) { addUnsigned(v); }
+    void add(char v) { addUnsigned((unsigned char)v); }
+    void add(bool v) { addUnsigned(v ? 1 : 0); }
+    void add(float v) { addFloat(v); }
+    void add(double v) { addFloat((float)v); }
+    void add(const char* v);
+
+    const uint8_t* data() const { return buf; }
+    uint8_t length() const { return len; }
+
+private:
+    uint8_t buf[LOG_MAX_ARG_BYTES];
+    uint8_t len;
+
+    void addSigned(long v);
+    void addUnsigned(unsigned long v);
+    void addFloat(float v);
+    bool reserve(size_t n) { return len + n <= LOG_MAX_ARG_BYTES; }
+    void putVarint(uint32_t v);
+};
+
+// 一条已读出的记录
+struct LogEntry {
+    uint32_t seq;
+    uint32_t ms;
+    uint8_t level;
+};
+
+// 读取位置，seq 为下一条要读的记录序号
+struct LogCursor {
+    uint32_t seq;
+    size_t offset;
+};
+
+// 非阻塞日志：write() 只把格式字符串地址和捕获的参数写入环形缓冲，
+// 格式化推迟到读取时进行。串口、/logs 和 MQTT 各自按序号游标读取，
+// drain() 在主循环中按串口发送缓冲的空闲空间输出，从不等待 UART。
+// 记录只在主循环中写入和读取，无需加锁；不要在中断中调用。
+class Log {
+public:
+    static void write(uint8_t level, PGM_P format) {
+        if (level > runtimeLevel) return;
+        LogArgs args;
+        append(level, format, args);
+    }
+
+    template <typename... Args>
+    static void write(uint8_t level, PGM_P format, Args... args) {
+        if (level > runtimeLevel) return;
+        LogArgs packed;
+        pack(packed, args...);
+        append(level, format, packed);
+    }
+
+    // 运行时级别，只能在编译期阈值之内进一步收紧
+    static void setLevel(uint8_t level) { runtimeLevel = level; }
+    static uint8_t getLevel() { return runtimeLevel; }
+
+    // 在loop()中调用，把新记录格式化后写入串口发送缓冲能容纳的部分
+    static void drain();
+
+    // 重启前调用，阻塞直到全部记录写出
+    static void flush();
+
+    // 把游标定位到序号大于 since 的第一条记录
+    static void seek(LogCursor& cursor, uint32_t since);
+
+    // 读取游标处的记录并格式化为文本，没有新记录时返回false。
+    // 游标指向的记录已被覆盖时跳到最旧的记录，调用方可由序号不连续发现缺口
+    static bool next(LogCursor& cursor, LogEntry& entry, char* text, size_t size);
+
+    // 以 JSON 数组写出一条记录：[seq,ms,"级别","文本"]，返回长度，空间不足时返回0
+    static size_t toJson(const LogEntry& entry, const char* text, char* out, size_t size);
+
+    static uint32_t getLatestSeq() { return nextSeq - 1; }
+    static uint32_t getOldestSeq() { return nextSeq == firstSeq ? 0 : firstSeq; }
+    static uint32_t getWritten() { return nextSeq - 1; }
+    static uint32_t getDropped() { return dropped; }   // 未输出到串口就被覆盖的记录
+    static size_t getUsed() { return used; }
+    static char levelChar(uint8_t level);
+
+private:
+    static uint8_t buffer[LOG_BUFFER_SIZE];
+    static size_t head;         // 下一条记录的写入位置
+    static size_t tail;         // 最旧记录的位置
+    static size_t used;
+    static uint32_t firstSeq;   // 最旧记录的序号
+    static uint32_t nextSeq;
+    static uint8_t runtimeLevel;
+    static uint32_t dropped;
+    static LogCursor serialCursor;
+
+    static void pack(LogArgs&) {}
+
+    template <typename T, typename... Rest>
+    static void pack(LogArgs& packed, T first, Rest... rest) {
+        packed.add(first);
+        pack(packed, rest...);
+    }
+
+    static void append(uint8_t level, PGM_P format, const LogArgs& args);
+    static void evictOldest();
+    static size_t recordSize(size_t offset);
+    static void copyIn(size_t offset, const void* data, size_t n);
+    static void copyOut(size_t offset, void* data, size_t n);
+    static size_t format(PGM_P format, const uint8_t* args, size_t argLen, char* out, size_t size);
+};
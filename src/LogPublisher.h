@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include "EspSmartWifi.h"
+#include "Log.h"
+
+// 发布间隔与单条消息大小，日志不应挤占遥测的带宽
+#define LOG_PUBLISH_INTERVAL_MS 2000
+#define LOG_PUBLISH_PAYLOAD_SIZE 1024
+
+// 把新日志记录按序号增量发布到 <topic>/log：
+// {"seq":最新序号,"logs":[[seq,ms,"级别","文本"],...]}，格式与 /logs 相同。
+// 只在配置中开启 log_mqtt 时发布，发布失败时下次从同一位置重试
+class LogPublisher {
+public:
+    explicit LogPublisher(PubSubClient& mqtt) : mqtt(mqtt), lastPublish(0) {
+        cursor.seq = 0;
+        cursor.offset = 0;
+    }
+
+    void begin(const Config& config) {
+        topic = config.LogMqtt ? config.Topic + "/log" : String();
+        // 从开机以来的第一条日志开始
+        Log::seek(cursor, 0);
+    }
+
+    // 在loop()中调用，发布成功返回true
+    bool loop() {
+        if (topic.length() == 0 || !mqtt.connected()) return false;
+        if (millis() - lastPublish < LOG_PUBLISH_INTERVAL_MS) return false;
+        lastPublish = millis();
+
+        int len = snprintf(payload, sizeof(payload), "{\"seq\":%lu,\"logs\":[",
+                           (unsigned long)Log::getLatestSeq());
+        LogCursor next = cursor;
+        LogCursor end = cursor;
+        LogEntry entry;
+        char text[LOG_LINE_SIZE];
+        size_t count = 0;
+        while (Log::next(next, entry, text, sizeof(text))) {
+            if (count > 0) payload[len++] = ',';
+            // 留出结尾 ]} 的空间
+            size_t n = Log::toJson(entry, text, payload + len, sizeof(payload) - len - 3);
+            if (n == 0) {
+                // 放不下的记录留到下一条消息
+                if (count > 0) len--;
+                break;
+            }
+            len += n;
+            count++;
+            end = next;
+        }
+        if (count == 0) return false;
+        len += snprintf(payload + len, sizeof(payload) - len, "]}");
+        if (!mqtt.publish(topic.c_str(), (const uint8_t*)payload, len)) return false;
+        cursor = end;
+        return true;
+    }
+
+private:
+    PubSubClient& mqtt;
+    String topic;
+    LogCursor cursor;
+    unsigned long lastPublish;
+    char payload[LOG_PUBLISH_PAYLOAD_SIZE];
+};
@@ -0,0 +1,162 @@
+#include "MqttConnection.h"
+#include "Log.h"
+#include "HeapMonitor.h"
+
+// 解析MQTT服务器地址
+bool parseMQTTServer(const String& serverUrl, MqttServer& server) {
+    // 检查URL格式
+    if (!serverUrl.startsWith("mqtt://")) {
+        LOG_ERROR("Invalid MQTT server URL format");
+        return false;
+    }
+
+    // 移除 mqtt:// 前缀
+    HeapMonitor::Scope heap(HEAP_SITE_URL_PARSE);
+    String url = serverUrl.substring(7);
+    
+    // 检查是否有认证信息
+    int atPos = url.indexOf('@');
+    if (atPos != -1) {
+        // 有认证信息
+        String auth = url.substring(0, atPos);
+        int colonPos = auth.indexOf(':');
+        if (colonPos != -1) {
+            server.username = auth.substring(0, colonPos);
+            server.password = auth.substring(colonPos + 1);
+        }
+        url = url.substring(atPos + 1);
+    }
+
+    // 检查是否有端口号
+    int colonPos = url.indexOf(':');
+    if (colonPos != -1) {
+        server.host = url.substring(0, colonPos);
+        server.port = url.substring(colonPos + 1).toInt();
+    } else {
+        server.host = url;
+        server.port = 1883; // 默认端口
+    }
+    heap.mark();
+
+    return server.host.length() > 0;
+}
+
+MqttConnection::MqttConnection(PubSubClient& mqtt, WiFiClient& client)
+    : mqtt(mqtt), client(client), resolved(false),
+      state(MQTT_STATE_INVALID), backoff(MQTT_BACKOFF_MIN_MS), retryDelay(0), waitStart(0),
+      attempts(0), failures(0), disconnects(0), connectingMillis(0), lastAttemptMillis(0),
+      lastError(0) {
+}
+
+bool MqttConnection::begin(const Config& config) {
+    if (!parseMQTTServer(config.Server, server)) {
+        state = MQTT_STATE_INVALID;
+        return false;
+    }
+
+    // 服务器为IP地址时无需DNS解析
+    resolved = serverIp.fromString(server.host);
+
+    // 生成客户端ID
+    clientId = "EspRouterPower" + String(ESP.getChipId(), HEX);
+
+    mqtt.setBufferSize(2048);
+    mqtt.setSocketTimeout(MQTT_CONNACK_TIMEOUT_S);
+    client.setTimeout(MQTT_TCP_TIMEOUT_MS);
+
+    state = MQTT_STATE_WAITING;
+    backoff = MQTT_BACKOFF_MIN_MS;
+    retryDelay = 0;     // 首次连接立即尝试
+    waitStart = millis();
+    LOG_INFO("MQTT server %s:%u", server.host.c_str(), server.port);
+    return true;
+}
+
+bool MqttConnection::loop() {
+    if (state == MQTT_STATE_INVALID) return false;
+
+    if (mqtt.connected()) {
+        mqtt.loop();
+        return false;
+    }
+
+    if (state == MQTT_STATE_CONNECTED) {
+        // 连接断开后立即重试一次，之后进入退避
+        disconnects++;
+        state = MQTT_STATE_WAITING;
+        backoff = MQTT_BACKOFF_MIN_MS;
+        retryDelay = 0;
+        waitStart = millis();
+    }
+
+    if (WiFi.status() != WL_CONNECTED) return false;
+    if (millis() - waitStart < retryDelay) return false;
+
+    return !attempt();
+}
+
+const char* MqttConnection::getStateName() const {
+    switch (state) {
+        case MQTT_STATE_INVALID: return "invalid";
+        case MQTT_STATE_WAITING: return "waiting";
+        case MQTT_STATE_CONNECTING: return "connecting";
+        case MQTT_STATE_CONNECTED: return "connected";
+    }
+    return "unknown";
+}
+
+unsigned long MqttConnection::getRetryInMillis() const {
+    if (state != MQTT_STATE_WAITING) return 0;
+    unsigned long waited = millis() - waitStart;
+    return waited >= retryDelay ? 0 : retryDelay - waited;
+}
+
+// 进行一次连接尝试，各阶段都有超时上限
+bool MqttConnection::attempt() {
+    state = MQTT_STATE_CONNECTING;
+    attempts++;
+    unsigned long start = millis();
+
+    if (!resolved) {
+        resolved = WiFi.hostByName(server.host.c_str(), serverIp, MQTT_DNS_TIMEOUT_MS) == 1;
+    }
+
+    bool ok = false;
+    if (resolved) {
+        mqtt.setServer(serverIp, server.port);
+        // 如果有认证信息，设置用户名和密码
+        if (server.username.length() > 0) {
+            ok = mqtt.connect(clientId.c_str(), server.username.c_str(), server.password.c_str());
+        } else {
+            ok = mqtt.connect(clientId.c_str());
+        }
+    }
+
+    lastAttemptMillis = millis() - start;
+    connectingMillis += lastAttemptMillis;
+
+    if (ok) {
+        state = MQTT_STATE_CONNECTED;
+        backoff = MQTT_BACKOFF_MIN_MS;
+        if (subscription.length() > 0) {
+            mqtt.subscribe(subscription.c_str());
+        }
+        LOG_INFO("MQTT connected in %lu ms", lastAttemptMillis);
+        return true;
+    }
+
+    failures++;
+    lastError = resolved ? mqtt.state() : MQTT_CONNECT_FAILED;
+    // 连接失败时下次重新解析，服务器地址可能已变化
+    resolved = serverIp.fromString(server.host);
+    scheduleRetry();
+    LOG_WARN("MQTT connect failed (rc=%d), retry in %lu ms", lastError, retryDelay);
+    return false;
+}
+
+void MqttConnection::scheduleRetry() {
+    state = MQTT_STATE_WAITING;
+    waitStart = millis();
+    retryDelay = backoff / 2 + random(backoff / 2 + 1);
+    backoff = backoff * 2 > MQTT_BACKOFF_MAX_MS ? MQTT_BACKOFF_MAX_MS : backoff * 2;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <PubSubClient.h>
+#include "EspSmartWifi.h"
+
+// 重连退避：从1秒开始翻倍，最长60秒，实际等待时间在 [退避/2, 退避] 之间随机
+#define MQTT_BACKOFF_MIN_MS 1000
+#define MQTT_BACKOFF_MAX_MS 60000
+// 单次连接各阶段的超时，限制一次尝试阻塞主循环的时间
+#define MQTT_DNS_TIMEOUT_MS 2000
+#define MQTT_TCP_TIMEOUT_MS 1500
+#define MQTT_CONNACK_TIMEOUT_S 2
+
+// MQTT服务器地址，mqtt://[username:password@]host[:port]
+struct MqttServer {
+    String host;
+    uint16_t port = 1883;
+    String username;
+    String password;
+};
+
+bool parseMQTTServer(const String& serverUrl, MqttServer& server);
+
+// MQTT连接管理：配置加载时只解析一次URL并缓存DNS结果，断开后按带随机抖动的
+// 指数退避重连，避免服务器不可用时主循环反复长时间阻塞。
+class MqttConnection {
+public:
+    enum State {
+        MQTT_STATE_INVALID = 0,   // 服务器地址无效，不再尝试
+        MQTT_STATE_WAITING,       // 等待WiFi或退避到期
+        MQTT_STATE_CONNECTING,
+        MQTT_STATE_CONNECTED
+    };
+
+    MqttConnection(PubSubClient& mqtt, WiFiClient& client);
+
+    bool begin(const Config& config);
+
+    // 每次连接成功后订阅的主题
+    void setSubscription(const String& topic) { subscription = topic; }
+
+    // 在loop()中调用：已连接时处理MQTT消息，断开时按退避计划重连。
+    // 本次调用进行了一次失败的连接尝试时返回true
+    bool loop();
+
+    bool connected() { return mqtt.connected(); }
+    State getState() const { return state; }
+    const char* getStateName() const;
+
+    // 连接指标
+    uint32_t getAttempts() const { return attempts; }
+    uint32_t getFailures() const { return failures; }
+    uint32_t getDisconnects() const { return disconnects; }
+    unsigned long getConnectingMillis() const { return connectingMillis; }   // 连接尝试累计耗时
+    unsigned long getLastAttemptMillis() const { return lastAttemptMillis; } // 最近一次尝试耗时
+    unsigned long getRetryInMillis() const;
+    int getLastError() const { return lastError; }    // PubSubClient::state()
+
+private:
+    PubSubClient& mqtt;
+    WiFiClient& client;
+    MqttServer server;
+    String clientId;
+    String subscription;
+    IPAddress serverIp;
+    bool resolved;
+
+    State state;
+    unsigned long backoff;          // 当前退避上限
+    unsigned long retryDelay;       // 本次实际等待时间
+    unsigned long waitStart;
+
+    uint32_t attempts;
+    uint32_t failures;
+    uint32_t disconnects;
+    unsigned long connectingMillis;
+    unsigned long lastAttemptMillis;
+    int lastError;
+
+    bool attempt();
+    void scheduleRetry();
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// 精简的 MessagePack 编码器，直接写入调用方提供的缓冲区，不分配内存。
+// 只实现遥测所需的类型：map、array、整数、字符串和布尔值。
+// 缓冲区不足时 overflow() 为 true，length() 不再可信。
+class MsgPackWriter {
+public:
+    MsgPackWriter(uint8_t* buffer, size_t size) : buf(buffer), size(size), pos(0), overflowed(false) {}
+
+    void writeMap(uint32_t count) {
+        if (count < 16) {
+            put(0x80 | count);
+        } else if (count <= 0xFFFF) {
+            put(0xDE);
+            put16(count);
+        } else {
+            put(0xDF);
+            put32(count);
+        }
+    }
+
+    void writeArray(uint32_t count) {
+        if (count < 16) {
+            put(0x90 | count);
+        } else if (count <= 0xFFFF) {
+            put(0xDC);
+            put16(count);
+        } else {
+            put(0xDD);
+            put32(count);
+        }
+    }
+
+    // 按数值大小选择最短的编码
+    void writeUInt(uint32_t value) {
+        if (value < 128) {
+            put(value);
+        } else if (value <= 0xFF) {
+            put(0xCC);
+            put(value);
+        } else if (value <= 0xFFFF) {
+            put(0xCD);
+            put16(value);
+        } else {
+            put(0xCE);
+            put32(value);
+        }
+    }
+
+    // 超出32位时用 uint 64，供长期累计的计数使用
+    void writeUInt64(uint64_t value) {
+        if (value <= 0xFFFFFFFF) {
+            writeUInt((uint32_t)value);
+        } else {
+            put(0xCF);
+            put32((uint32_t)(value >> 32));
+            put32((uint32_t)value);
+        }
+    }
+
+    void writeInt(int32_t value) {
+        if (value >= 0) {
+            writeUInt(value);
+        } else if (value >= -32) {
+            put((uint8_t)(int8_t)value);
+        } else if (value >= -128) {
+            put(0xD0);
+            put((uint8_t)(int8_t)value);
+        } else if (value >= -32768) {
+            put(0xD1);
+            put16((uint16_t)(int16_t)value);
+        } else {
+            put(0xD2);
+            put32((uint32_t)value);
+        }
+    }
+
+    void writeString(const char* str) {
+        size_t len = strlen(str);
+        if (len < 32) {
+            put(0xA0 | len);
+        } else if (len <= 0xFF) {
+            put(0xD9);
+            put(len);
+        } else {
+            put(0xDA);
+            put16(len);
+        }
+        putBytes((const uint8_t*)str, len);
+    }
+
+    void writeBool(bool value) {
+        put(value ? 0xC3 : 0xC2);
+    }
+
+    size_t length() const { return pos; }
+    bool overflow() const { return overflowed; }
+
+    // 已写出的内容发送后复用缓冲区
+    void reset() {
+        pos = 0;
+        overflowed = false;
+    }
+
+private:
+    uint8_t* buf;
+    size_t size;
+    size_t pos;
+    bool overflowed;
+
+    void put(uint8_t b) {
+        if (pos >= size) {
+            overflowed = true;
+            return;
+        }
+        buf[pos++] = b;
+    }
+
+    void put16(uint16_t v) {
+        put(v >> 8);
+        put(v & 0xFF);
+    }
+
+    void put32(uint32_t v) {
+        put16(v >> 16);
+        put16(v & 0xFFFF);
+    }
+
+    void putBytes(const uint8_t* data, size_t len) {
+        if (pos + len > size) {
+            overflowed = true;
+            return;
+        }
+        memcpy(buf + pos, data, len);
+        pos += len;
+    }
+};
\ No newline at end of file
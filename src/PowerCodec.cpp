@@ -0,0 +1,108 @@
+#include "PowerCodec.h"
+#include <stdio.h>
+
+void writeSnapshotMsgPack(MsgPackWriter& writer, const PowerSample& sample) {
+    writer.writeMap(5);
+    writer.writeString("seq");
+    writer.writeUInt(sample.seq);
+    writer.writeString("ms");
+    writer.writeUInt(sample.ms);
+    writer.writeString("mv");
+    writer.writeInt(toFixed(sample.voltage, 1000));
+    writer.writeString("ma10");
+    writer.writeInt(toFixed(sample.current, 10));
+    writer.writeString("mw");
+    writer.writeInt(toFixed(sample.power, 1));
+}
+
+void writeSampleMsgPack(MsgPackWriter& writer, const PowerSample& sample, uint32_t ms0) {
+    writer.writeArray(4);
+    writer.writeUInt(sample.ms - ms0);
+    writer.writeInt(toFixed(sample.voltage, 1000));
+    writer.writeInt(toFixed(sample.current, 10));
+    writer.writeInt(toFixed(sample.power, 1));
+}
+
+void writeSampleMsgPack(MsgPackWriter& writer, const PowerSample& sample, const PowerExtremes& extremes,
+                        uint32_t seq0, uint32_t ms0) {
+    writer.writeArray(11);
+    writer.writeUInt(sample.seq - seq0);
+    writer.writeUInt(sample.ms - ms0);
+    writer.writeInt(toFixed(sample.voltage, 1000));
+    writer.writeInt(toFixed(sample.current, 10));
+    writer.writeInt(toFixed(sample.power, 1));
+    writer.writeInt(toFixed(extremes.minVoltage, 1000));
+    writer.writeInt(toFixed(extremes.maxVoltage, 1000));
+    writer.writeInt(toFixed(extremes.minCurrent, 10));
+    writer.writeInt(toFixed(extremes.maxCurrent, 10));
+    writer.writeInt(toFixed(extremes.minPower, 1));
+    writer.writeInt(toFixed(extremes.maxPower, 1));
+}
+
+// {"seq":最后序号,"ts":Unix时间,"ms":millis(),"mwh":最后样本的累计电能,
+//  "channel1":{最新样本，兼容单点格式},"samples":[[seq,ms,V,mA,mW],...]}
+// 带极值时每个样本追加 [...,V最小,V最大,mA最小,mA最大,mW最小,mW最大]
+size_t encodeBatchJson(const PowerSample* samples, const PowerExtremes* extremes, size_t count,
+                       uint32_t ts, uint32_t now, char* out, size_t size) {
+    if (count == 0) return 0;
+    const PowerSample& last = samples[count - 1];
+    int len = snprintf(out, size,
+                       "{\"seq\":%lu,\"ts\":%lu,\"ms\":%lu,\"mwh\":%.3f,"
+                       "\"channel1\":{\"current\":%.1f,\"voltage\":%.3f,\"power\":%.0f},\"samples\":[",
+                       (unsigned long)last.seq, (unsigned long)ts, (unsigned long)now, last.energy,
+                       last.current, last.voltage, last.power);
+    for (size_t i = 0; i < count && len < (int)size; i++) {
+        const PowerSample& s = samples[i];
+        len += snprintf(out + len, size - len, "%s[%lu,%lu,%.3f,%.1f,%.0f",
+                        i == 0 ? "" : ",", (unsigned long)s.seq, (unsigned long)s.ms,
+                        s.voltage, s.current, s.power);
+        if (extremes != nullptr && len < (int)size) {
+            const PowerExtremes& e = extremes[i];
+            len += snprintf(out + len, size - len, ",%.3f,%.3f,%.1f,%.1f,%.0f,%.0f",
+                            e.minVoltage, e.maxVoltage, e.minCurrent, e.maxCurrent,
+                            e.minPower, e.maxPower);
+        }
+        if (len < (int)size) {
+            len += snprintf(out + len, size - len, "]");
+        }
+    }
+    if (len < (int)size) {
+        len += snprintf(out + len, size - len, "]}");
+    }
+    // 缓冲区不足时放弃，避免发出截断的JSON
+    if (len >= (int)size) return 0;
+    return len;
+}
+
+// {"seq":最后序号,"ts":Unix时间,"ms":millis(),"uwh":累计电能,"seq0":首个序号,"ms0":首个样本ms,
+//  "samples":[[ms-ms0,mv,ma10,mw],...]}，带极值时样本格式见 writeSampleMsgPack。
+// 累计电能以 µWh 定点，与 JSON 中三位小数的 mWh 精度相同；按 64 位写出，32 位的 µWh 约 4.3kWh 即回绕
+size_t encodeBatchMsgPack(const PowerSample* samples, const PowerExtremes* extremes, size_t count,
+                          uint32_t ts, uint32_t now, uint8_t* out, size_t size) {
+    if (count == 0) return 0;
+    MsgPackWriter writer(out, size);
+    writer.writeMap(7);
+    writer.writeString("seq");
+    writer.writeUInt(samples[count - 1].seq);
+    writer.writeString("ts");
+    writer.writeUInt(ts);
+    writer.writeString("ms");
+    writer.writeUInt(now);
+    writer.writeString("uwh");
+    double uwh = samples[count - 1].energy * 1000.0;
+    writer.writeUInt64(uwh > 0 ? (uint64_t)(uwh + 0.5) : 0);
+    writer.writeString("seq0");
+    writer.writeUInt(samples[0].seq);
+    writer.writeString("ms0");
+    writer.writeUInt(samples[0].ms);
+    writer.writeString("samples");
+    writer.writeArray(count);
+    for (size_t i = 0; i < count; i++) {
+        if (extremes != nullptr) {
+            writeSampleMsgPack(writer, samples[i], extremes[i], samples[0].seq, samples[0].ms);
+        } else {
+            writeSampleMsgPack(writer, samples[i], samples[0].ms);
+        }
+    }
+    return writer.overflow() ? 0 : writer.length();
+}
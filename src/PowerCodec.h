@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "PowerSample.h"
+#include "MsgPack.h"
+
+// 负载编码方式，MQTT 与 HTTP 共用
+enum PayloadEncoding {
+    ENCODING_JSON = 0,
+    ENCODING_MSGPACK
+};
+
+// MessagePack 使用整数定点字段：电压 mV，电流 0.1mA（即 mA*10），功率 mW，累计电能 µWh
+inline int32_t toFixed(float value, float scale) {
+    float scaled = value * scale;
+    return (int32_t)(scaled >= 0 ? scaled + 0.5f : scaled - 0.5f);
+}
+
+// 单个样本：{"seq","ms","mv","ma10","mw"}，供 /power 使用
+void writeSnapshotMsgPack(MsgPackWriter& writer, const PowerSample& sample);
+
+// 样本数组中的一项：[相对 ms0 的毫秒数, mv, ma10, mw]，序号为 seq0 + 下标。
+// 带极值时为 [相对 seq0 的序号差, 相对 ms0 的毫秒数, mv, ma10, mw,
+// mv最小, mv最大, ma10最小, ma10最大, mw最小, mw最大]，按变化上报时序号不连续
+void writeSampleMsgPack(MsgPackWriter& writer, const PowerSample& sample, uint32_t ms0);
+void writeSampleMsgPack(MsgPackWriter& writer, const PowerSample& sample, const PowerExtremes& extremes,
+                        uint32_t seq0, uint32_t ms0);
+
+// MQTT批量消息，ts 为发布时刻的Unix时间，now 为发布时刻 millis()。
+// extremes 非空时每个样本附带自上次上报以来的极值。
+// 返回写入的字节数，缓冲区不足时返回0
+size_t encodeBatchJson(const PowerSample* samples, const PowerExtremes* extremes, size_t count,
+                       uint32_t ts, uint32_t now, char* out, size_t size);
+size_t encodeBatchMsgPack(const PowerSample* samples, const PowerExtremes* extremes, size_t count,
+                          uint32_t ts, uint32_t now, uint8_t* out, size_t size);
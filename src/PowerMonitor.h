@@ -2,10 +2,30 @@
 
 #include <Wire.h>
 #include <Adafruit_INA219.h>
+#include "I2cBus.h"
+#include "PowerSample.h"
+#include "SnapshotCache.h"
+#include "SensorTrace.h"
+#include "Log.h"
+
+// 采样周期与历史缓冲长度（128 x 250ms ≈ 32秒）
+#define POWER_SAMPLE_INTERVAL_MS 250
+#define POWER_HISTORY_SIZE 128
+// 与 setCalibration_32V_2A() 一致：校准值、电流每位0.1mA、功率每位2mW
+#define POWER_CAL_VALUE 4096
+#define POWER_CURRENT_DIVIDER_MA 10
+#define POWER_MULTIPLIER_MW 2
+// 每个寄存器传输失败后的重试次数；连续这么多次采样失败后恢复总线并重新初始化传感器
+#define POWER_READ_RETRIES 2
+#define POWER_RECOVER_AFTER 3
+// 默认 ADC 设置，与 setCalibration_32V_2A() 相同：电压、分流各一次12位转换，共约1.06ms
+#define POWER_BUS_ADC INA219_CONFIG_BADCRES_12BIT
+#define POWER_SHUNT_ADC INA219_CONFIG_SADCRES_12BIT_1S_532US
 
 class PowerMonitor {
 public:
-    PowerMonitor() : ina219() {
+    PowerMonitor() : ina219(), bus(nullptr), engine(nullptr), busDevice(-1), trace(nullptr),
+                     busADC(POWER_BUS_ADC), shuntADC(POWER_SHUNT_ADC) {
         for (int i = 0; i < 10; ++i) {
             currentBuffer[i] = 0;
             powerBuffer[i] = 0;
@@ -14,10 +34,27 @@ public:
         bufferCount = 0;
         powerIndex = 0;
         powerCount = 0;
+        initialized = false;
+        nextSeq = 1;
+        historyHead = 0;
+        historyCount = 0;
+        lastSampleMillis = 0;
+        energy_uJ = 0;
+        pendingFlags = 0;
+        consecutiveFailures = 0;
+        failedSamples = 0;
+        reinits = 0;
+        sampling = false;
+        step = 0;
+        latencyWindowStart = 0;
     }
     
-    bool begin() {
-        Wire.begin();
+    // 总线由 I2cBus 初始化，这里只登记设备。初始化和恢复用驱动库同步完成，
+    // 周期采样通过排队引擎异步读取寄存器
+    bool begin(I2cBus& i2c, I2cEngine& queue) {
+        bus = &i2c;
+        engine = &queue;
+        busDevice = bus->addDevice("ina219", INA219_ADDRESS);
         if (!ina219.begin()) {
             Serial.println("Failed to find INA219 chip");
             return false;
@@ -28,7 +65,7 @@ public:
         // 最大电流 = 3.2A
         // 最大电压 = 32V
         // 分流电阻 = 0.01Ω
-        ina219.setCalibration_32V_2A();
+        configure();
         
         // 打印配置信息
         Serial.println("INA219 initialized successfully");
@@ -37,58 +74,282 @@ public:
         Serial.println("- Max Current: 3.2A");
         Serial.println("- Max Voltage: 32V");
         
+        initialized = true;
         return true;
     }
     
-    float getBusVoltage_V() {
-        return ina219.getBusVoltage_V();
+    bool isInitialized() {
+        return initialized;
     }
-    
-    float getCurrent_mA() {
-        float rawCurrent = ina219.getCurrent_mA();
-        if (rawCurrent < 0) {
-            // 负数不入队，直接返回当前平均
+
+    // 在loop()中调用，按固定周期开始一组寄存器读取，全部完成后写入历史缓冲
+    void update() {
+        if (!initialized || sampling) return;
+        unsigned long now = millis();
+        if (historyCount > 0 && now - lastSampleMillis < POWER_SAMPLE_INTERVAL_MS) return;
+        lastSampleMillis = now;
+        startSample();
+        // 预告下一次读取，显示刷新会在此之前让出总线
+        bus->reserve(lastSampleMillis + POWER_SAMPLE_INTERVAL_MS);
+    }
+
+    // 采样过程：重写校准寄存器（芯片复位后为0，电流和功率会读成0）→ 电流 → 电压 → 功率，
+    // 每步在上一步的完成回调中提交。任一步重试后仍失败则放弃本次采样
+    void startSample() {
+        sampling = true;
+        step = 0;
+        sampleMillis = millis();
+        sampleCycles = ESP.getCycleCount();
+        if (!engine->writeRegister16(busDevice, INA219_ADDRESS, INA219_REG_CALIBRATION, POWER_CAL_VALUE,
+                                     POWER_READ_RETRIES, onTransfer, this)) {
+            sampleFailed();
+        }
+    }
+
+    // 清零累计电能，返回清零前的值（mWh），下一个样本从0开始积分
+    float resetEnergy() {
+        float previous = energy_uJ / 3600000.0;
+        energy_uJ = 0;
+        return previous;
+    }
+
+    // 最新样本的预序列化结果，供 /power 直接发送
+    const SnapshotCache& getSnapshot() const {
+        return snapshot;
+    }
+
+    // 最新样本的序号，尚无采样时为0
+    uint32_t getLatestSeq() const {
+        return nextSeq - 1;
+    }
+
+    // 缓冲中最旧样本的序号，尚无采样时为0
+    uint32_t getOldestSeq() const {
+        return historyCount == 0 ? 0 : nextSeq - historyCount;
+    }
+
+    bool getLatest(PowerSample& out) const {
+        if (historyCount == 0) return false;
+        out = history[(historyHead + POWER_HISTORY_SIZE - 1) % POWER_HISTORY_SIZE];
+        return true;
+    }
+
+    // 缓冲中序号大于 seq 的样本个数
+    size_t getCountSince(uint32_t seq) const {
+        uint32_t latest = getLatestSeq();
+        if (historyCount == 0 || seq >= latest) return 0;
+        uint32_t first = seq + 1;
+        uint32_t oldest = getOldestSeq();
+        if (first < oldest) first = oldest;
+        return latest - first + 1;
+    }
+
+    // 按从旧到新的顺序拷贝序号大于 seq 的样本，最多 maxCount 个，返回实际个数。
+    // 若 seq 早于缓冲中最旧的样本，则从最旧的样本开始（调用方可据此发现缺口）。
+    size_t getSamplesSince(uint32_t seq, PowerSample* out, size_t maxCount) const {
+        size_t count = getCountSince(seq);
+        if (count == 0) return 0;
+        uint32_t latest = getLatestSeq();
+        uint32_t first = latest - count + 1;
+        if (count > maxCount) count = maxCount;
+        // 最新样本位于 historyHead-1，向前偏移 latest-first 个即为 first
+        size_t index = (historyHead + POWER_HISTORY_SIZE - 1 - (latest - first)) % POWER_HISTORY_SIZE;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = history[index];
+            index = (index + 1) % POWER_HISTORY_SIZE;
+        }
+        return count;
+    }
+
+    // 设置后每次寄存器读取的原始值都交给录制器，供主机重放
+    void setTrace(TraceRecorder* recorder) { trace = recorder; }
+
+    // 设置电压、分流 ADC 的分辨率和平均次数（INA219_CONFIG_BADCRES_* / SADCRES_*），
+    // 重新初始化传感器后仍然有效。两次转换时间之和决定新数据的最高速率
+    bool setADCResolution(uint16_t bus, uint16_t shunt) {
+        busADC = bus;
+        shuntADC = shunt;
+        return !initialized || ina219.setADCResolution(busADC, shuntADC);
+    }
+
+    // 一次采样从开始到写入历史的耗时（含排队等待总线），倒数即端到端可达的采样率
+    const LatencyStats& getSampleLatency() const { return sampleLatency; }
+
+    // 读取失败（重试后仍失败）而跳过的采样次数
+    uint32_t getFailedSamples() const { return failedSamples; }
+    // 恢复总线后重新初始化传感器的次数
+    uint32_t getReinits() const { return reinits; }
+
+private:
+    // 0.01Ω分流电阻，最大电流3.2A，最大电压32V
+    void configure() {
+        ina219.setCalibration_32V_2A();
+        if (busADC != POWER_BUS_ADC || shuntADC != POWER_SHUNT_ADC) {
+            ina219.setADCResolution(busADC, shuntADC);
+        }
+    }
+
+    // 把读到的原始值写入历史缓冲。失败而跳过的采样不写入，
+    // 下一个成功的样本带 SAMPLE_FLAG_GAP
+    void storeSample() {
+        PowerSample& s = history[historyHead];
+        s.seq = nextSeq++;
+        s.ms = sampleMillis;
+        s.current = averageCurrent((float)rawCurrent / POWER_CURRENT_DIVIDER_MA);
+        s.voltage = (rawBusVoltage >> 3) * 4 * 0.001;   // 高13位，每位4mV
+        s.power = averagePower((float)rawPower * POWER_MULTIPLIER_MW);
+        s.flags = pendingFlags;
+        pendingFlags = 0;
+        // 按采样间隔积分电能（mW * ms = μJ），采样延迟时按实际间隔计算，不会漏计
+        if (historyCount > 0) {
+            uint32_t dt = s.ms - history[(historyHead + POWER_HISTORY_SIZE - 1) % POWER_HISTORY_SIZE].ms;
+            if (s.power > 0) energy_uJ += (uint64_t)(s.power * dt);
+        }
+        s.energy = energy_uJ / 3600000.0;
+        sampleLatency.record(ESP.getCycleCount() - sampleCycles);
+        if (s.ms - latencyWindowStart >= LATENCY_WINDOW_MS) {
+            latencyWindowStart = s.ms;
+            sampleLatency.roll();
+        }
+        historyHead = (historyHead + 1) % POWER_HISTORY_SIZE;
+        if (historyCount < POWER_HISTORY_SIZE) historyCount++;
+        snapshot.update(s);
+    }
+
+    static void onTransfer(const I2cRequest& request, void* context) {
+        static_cast<PowerMonitor*>(context)->handleTransfer(request);
+    }
+
+    void handleTransfer(const I2cRequest& request) {
+        if (request.attempts > 1) pendingFlags |= SAMPLE_FLAG_RETRIED;
+        if (trace != nullptr && request.rxLen == 2) {
+            trace->record(request.address, request.tx[0], request.value16(), request.ok);
+        }
+        if (!request.ok) {
+            sampleFailed();
+            return;
+        }
+        bool submitted = false;
+        switch (step++) {
+            case 0:
+                submitted = readRegister(INA219_REG_CURRENT);
+                break;
+            case 1:
+                rawCurrent = (int16_t)request.value16();
+                submitted = readRegister(INA219_REG_BUSVOLTAGE);
+                break;
+            case 2:
+                rawBusVoltage = request.value16();
+                submitted = readRegister(INA219_REG_POWER);
+                break;
+            default:
+                rawPower = (int16_t)request.value16();
+                sampling = false;
+                consecutiveFailures = 0;
+                storeSample();
+                return;
+        }
+        if (!submitted) sampleFailed();
+    }
+
+    bool readRegister(uint8_t reg) {
+        return engine->readRegister16(busDevice, INA219_ADDRESS, reg, POWER_READ_RETRIES, onTransfer, this);
+    }
+
+    // 连续失败时恢复总线并重新初始化传感器
+    void sampleFailed() {
+        sampling = false;
+        failedSamples++;
+        pendingFlags |= SAMPLE_FLAG_GAP;
+        if (++consecutiveFailures >= POWER_RECOVER_AFTER) {
+            consecutiveFailures = 0;
+            recover();
+        }
+    }
+
+    // 芯片掉电复位后配置和校准寄存器恢复为默认值，需重新写入
+    void recover() {
+        bus->recover();
+        if (ina219.begin()) {
+            configure();
+            reinits++;
+            pendingFlags |= SAMPLE_FLAG_REINIT;
+            LOG_WARN("INA219 re-initialized after I2C errors");
+        } else {
+            LOG_ERROR("INA219 not responding after bus recovery");
+        }
+        // begin() 会重新初始化 Wire，恢复总线时钟
+        bus->restoreClock();
+    }
+
+    // 电流、功率的滑动平均，负值不入队，直接返回当前平均
+    float averageCurrent(float value) {
+        if (value < 0) {
             if (bufferCount == 0) return 0;
             float sum = 0;
             for (int i = 0; i < bufferCount; i++) sum += currentBuffer[i];
             return sum / bufferCount;
         }
-        // 入队
-        currentBuffer[bufferIndex] = rawCurrent;
+        currentBuffer[bufferIndex] = value;
         bufferIndex = (bufferIndex + 1) % 10;
         if (bufferCount < 10) bufferCount++;
-        // 计算平均
         float sum = 0;
         for (int i = 0; i < bufferCount; i++) sum += currentBuffer[i];
         return sum / bufferCount;
     }
-    
-    float getPower_mW() {
-        float rawPower = ina219.getPower_mW();
-        if (rawPower < 0) {
+
+    float averagePower(float value) {
+        if (value < 0) {
             if (powerCount == 0) return 0;
             float sum = 0;
             for (int i = 0; i < powerCount; i++) sum += powerBuffer[i];
             return sum / powerCount;
         }
-        powerBuffer[powerIndex] = rawPower;
+        powerBuffer[powerIndex] = value;
         powerIndex = (powerIndex + 1) % 10;
         if (powerCount < 10) powerCount++;
         float sum = 0;
         for (int i = 0; i < powerCount; i++) sum += powerBuffer[i];
         return sum / powerCount;
     }
-    
-    bool isInitialized() {
-        return ina219.begin();
-    }
 
-private:
     Adafruit_INA219 ina219;
+    I2cBus* bus;
+    I2cEngine* engine;
+    int busDevice;
+    TraceRecorder* trace;
+    uint16_t busADC;
+    uint16_t shuntADC;
     float currentBuffer[10];
     int bufferIndex;
     int bufferCount;
     float powerBuffer[10];
     int powerIndex;
     int powerCount;
+    bool initialized;
+
+    // 采样历史环形缓冲
+    PowerSample history[POWER_HISTORY_SIZE];
+    uint32_t nextSeq;
+    size_t historyHead;
+    size_t historyCount;
+    unsigned long lastSampleMillis;
+    uint64_t energy_uJ;
+    uint8_t pendingFlags;           // 写入下一个样本的标志
+    uint8_t consecutiveFailures;
+    uint32_t failedSamples;
+    uint32_t reinits;
+
+    // 进行中的一组读取
+    bool sampling;
+    uint8_t step;
+    unsigned long sampleMillis;
+    uint32_t sampleCycles;
+    int16_t rawCurrent;
+    uint16_t rawBusVoltage;
+    int16_t rawPower;
+
+    SnapshotCache snapshot;
+    LatencyStats sampleLatency;
+    unsigned long latencyWindowStart;
 }; 
\ No newline at end of file
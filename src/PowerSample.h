@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+// 样本标志
+#define SAMPLE_FLAG_RETRIED 0x01    // 读取失败，重试后成功
+#define SAMPLE_FLAG_GAP     0x02    // 此前有读取失败而被跳过的采样
+#define SAMPLE_FLAG_REINIT  0x04    // 总线恢复、传感器重新初始化后的第一个样本
+
+// 一次采样的结果，seq 从1开始单调递增，0 表示“尚无采样”
+struct PowerSample {
+    uint32_t seq;
+    uint32_t ms;        // 采样时刻 millis()
+    float voltage;      // V
+    float current;      // mA（滑动平均后）
+    float power;        // mW（滑动平均后）
+    float energy;       // mWh，启动以来的累计电能
+    uint8_t flags;      // SAMPLE_FLAG_*
+};
+
+// 两次上报之间全部样本的极值，按变化上报时随样本一起发布，避免尖峰被死区过滤掉
+struct PowerExtremes {
+    float minVoltage;
+    float maxVoltage;
+    float minCurrent;
+    float maxCurrent;
+    float minPower;
+    float maxPower;
+};
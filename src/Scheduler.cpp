@@ -0,0 +1,89 @@
+#include "Scheduler.h"
+#include "Log.h"
+
+int Scheduler::addTask(const char* name, void (*run)(), uint32_t period, uint8_t priority, uint32_t budget) {
+    if (taskCount >= SCHEDULER_MAX_TASKS) {
+        LOG_ERROR("Scheduler full, task %s not added", name);
+        return -1;
+    }
+    SchedulerTask& task = tasks[taskCount];
+    task.name = name;
+    task.run = run;
+    task.period = period;
+    task.priority = priority;
+    task.budget = budget;
+    task.nextDue = millis();
+    task.runs = 0;
+    task.overruns = 0;
+    return taskCount++;
+}
+
+bool Scheduler::setBudget(const char* name, uint32_t budget) {
+    for (size_t i = 0; i < taskCount; i++) {
+        if (strcmp(tasks[i].name, name) == 0) {
+            tasks[i].budget = budget;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t Scheduler::getOverruns() const {
+    uint32_t total = 0;
+    for (size_t i = 0; i < taskCount; i++) total += tasks[i].overruns;
+    return total;
+}
+
+void Scheduler::loop() {
+    uint32_t cycles = ESP.getCycleCount();
+    if (lastLoopCycles != 0) {
+        loopLatency.record(cycles - lastLoopCycles);
+    }
+    lastLoopCycles = cycles;
+
+    unsigned long now = millis();
+    // 窗口结束时滚动全部统计
+    if (now - windowStart >= LATENCY_WINDOW_MS) {
+        windowStart = now;
+        loopLatency.roll();
+        for (size_t i = 0; i < taskCount; i++) tasks[i].latency.roll();
+    }
+
+    // 选出最紧迫的到期任务
+    SchedulerTask* next = nullptr;
+    for (size_t i = 0; i < taskCount; i++) {
+        SchedulerTask& task = tasks[i];
+        if ((long)(now - task.nextDue) < 0) continue;
+        if (next == nullptr || task.priority > next->priority ||
+            (task.priority == next->priority && (long)(task.nextDue - next->nextDue) < 0)) {
+            next = &task;
+        }
+    }
+
+    if (next == nullptr) {
+        idleCount++;
+        yield();
+        return;
+    }
+
+    // 周期计数器读一次只需几个时钟周期，比 micros() 更精确也更便宜
+    uint32_t start = ESP.getCycleCount();
+    next->run();
+    uint32_t elapsedCycles = ESP.getCycleCount() - start;
+    next->latency.record(elapsedCycles);
+    uint32_t elapsed = elapsedCycles / LatencyStats::cyclesPerMicro();
+
+    next->runs++;
+    if (elapsed > next->budget) {
+        next->overruns++;
+        LOG_DEBUG("Task %s took %lu us (budget %lu us)", next->name, (unsigned long)elapsed,
+                  (unsigned long)next->budget);
+    }
+
+    // 按周期推进；错过的周期不补跑，从现在重新计时
+    next->nextDue += next->period;
+    now = millis();
+    if ((long)(now - next->nextDue) >= 0) {
+        next->nextDue = now + next->period;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+#include "LatencyStats.h"
+
+#define SCHEDULER_MAX_TASKS 16
+
+// 任务优先级，数值越大越优先
+enum TaskPriority {
+    PRIORITY_LOW = 0,       // 显示、日志等可以延后的工作
+    PRIORITY_NORMAL,        // 网络
+    PRIORITY_HIGH,          // 按钮、电压保护
+    PRIORITY_CRITICAL       // 采样
+};
+
+struct SchedulerTask {
+    const char* name;
+    void (*run)();
+    uint32_t period;        // ms，0 表示每轮都到期
+    uint8_t priority;
+    uint32_t budget;        // 单次运行的时间预算（μs）
+    unsigned long nextDue;  // 下次到期的 millis()
+    uint32_t runs;
+    uint32_t overruns;      // 运行时间超出预算的次数
+    LatencyStats latency;   // 单次运行耗时
+};
+
+// 协作式调度器：每次 loop() 只运行一个到期任务，优先级最高者优先，
+// 同优先级时选择到期最早（等待最久）的任务。没有任务到期时让出CPU，
+// 不再固定 delay(1)。任务不可抢占，超出预算只计数，
+// 因此长任务之后下一轮总是先检查高优先级任务。
+class Scheduler {
+public:
+    Scheduler() : taskCount(0), idleCount(0), windowStart(0), lastLoopCycles(0) {}
+
+    // 注册任务，返回任务编号，任务表已满时返回-1
+    int addTask(const char* name, void (*run)(), uint32_t period, uint8_t priority, uint32_t budget);
+
+    // 在loop()中调用
+    void loop();
+
+    // 运行时调整任务的时间预算（μs），找不到任务时返回false
+    bool setBudget(const char* name, uint32_t budget);
+
+    size_t getTaskCount() const { return taskCount; }
+    const SchedulerTask& getTask(size_t index) const { return tasks[index]; }
+    uint32_t getIdleCount() const { return idleCount; }
+    uint32_t getOverruns() const;
+    // 相邻两次 loop() 调用之间的间隔，包括系统（WiFi协议栈）占用的时间
+    const LatencyStats& getLoopLatency() const { return loopLatency; }
+
+private:
+    SchedulerTask tasks[SCHEDULER_MAX_TASKS];
+    size_t taskCount;
+    uint32_t idleCount;
+
+    LatencyStats loopLatency;
+    unsigned long windowStart;
+    uint32_t lastLoopCycles;
+};
@@ -0,0 +1,109 @@
+#include "SensorTrace.h"
+#include "Log.h"
+
+static const char TRACE_MAGIC[4] = {'P', 'T', 'R', 'C'};
+
+void encodeTraceHeader(uint8_t* out) {
+    memcpy(out, TRACE_MAGIC, 4);
+    out[4] = TRACE_VERSION;
+    out[5] = TRACE_RECORD_SIZE;
+    out[6] = 0;
+    out[7] = 0;
+}
+
+bool decodeTraceHeader(const uint8_t* in) {
+    return memcmp(in, TRACE_MAGIC, 4) == 0 && in[4] == TRACE_VERSION && in[5] == TRACE_RECORD_SIZE;
+}
+
+void encodeTraceRecord(const TraceRecord& record, uint8_t* out) {
+    out[0] = record.ms & 0xFF;
+    out[1] = (record.ms >> 8) & 0xFF;
+    out[2] = (record.ms >> 16) & 0xFF;
+    out[3] = record.ms >> 24;
+    out[4] = record.address;
+    out[5] = record.reg;
+    out[6] = record.value & 0xFF;
+    out[7] = record.value >> 8;
+}
+
+void decodeTraceRecord(const uint8_t* in, TraceRecord& record) {
+    record.ms = (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+    record.address = in[4];
+    record.reg = in[5];
+    record.value = (uint16_t)in[6] | ((uint16_t)in[7] << 8);
+}
+
+TraceRecorder::TraceRecorder()
+    : buffered(0), recording(false), startMillis(0), duration(0), records(0), dropped(0), bytes(0) {
+}
+
+bool TraceRecorder::start(unsigned long durationMs) {
+    stop();
+    file = SPIFFS.open(TRACE_FILE, "w");
+    if (!file) {
+        LOG_ERROR("Trace: cannot create %s", TRACE_FILE);
+        return false;
+    }
+    uint8_t header[TRACE_HEADER_SIZE];
+    encodeTraceHeader(header);
+    if (file.write(header, sizeof(header)) != sizeof(header)) {
+        file.close();
+        return false;
+    }
+    file.flush();
+
+    buffered = 0;
+    records = 0;
+    dropped = 0;
+    bytes = TRACE_HEADER_SIZE;
+    startMillis = millis();
+    duration = durationMs > TRACE_MAX_DURATION_MS ? TRACE_MAX_DURATION_MS : durationMs;
+    recording = true;
+    LOG_INFO("Trace: recording for %lu ms", duration);
+    return true;
+}
+
+void TraceRecorder::stop() {
+    if (!recording) return;
+    flush();
+    file.close();
+    recording = false;
+    LOG_INFO("Trace: stopped, %lu records, %lu dropped", (unsigned long)records, (unsigned long)dropped);
+}
+
+void TraceRecorder::record(uint8_t address, uint8_t reg, uint16_t value, bool ok) {
+    if (!recording) return;
+    if (buffered == TRACE_BUFFER_RECORDS || bytes + (buffered + 1) * TRACE_RECORD_SIZE > TRACE_MAX_BYTES) {
+        dropped++;
+        return;
+    }
+    TraceRecord r;
+    r.ms = millis();
+    r.address = address;
+    r.reg = ok ? reg : (reg | TRACE_REG_FAILED);
+    r.value = ok ? value : 0;
+    encodeTraceRecord(r, buffer + buffered * TRACE_RECORD_SIZE);
+    buffered++;
+}
+
+void TraceRecorder::loop() {
+    if (!recording) return;
+    flush();
+    if (millis() - startMillis >= duration || bytes + TRACE_RECORD_SIZE > TRACE_MAX_BYTES) {
+        stop();
+    }
+}
+
+void TraceRecorder::flush() {
+    if (buffered == 0) return;
+    size_t n = buffered * TRACE_RECORD_SIZE;
+    if (file.write(buffer, n) != n) {
+        dropped += buffered;
+    } else {
+        records += buffered;
+        bytes += n;
+    }
+    // 录制中也可下载文件，写出的记录立即落盘
+    file.flush();
+    buffered = 0;
+}
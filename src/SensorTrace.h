@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+// 传感器寄存器跟踪：记录每次读到的原始寄存器值及时刻，主机上按原时序重放，
+// 用真实负载曲线回归测试滤波、死区和保护阈值。
+//
+// 文件格式（小端）：8字节文件头 "PTRC" + 版本(1) + 记录长度(1) + 保留(2)，
+// 之后每条记录8字节：ms(4) + I2C地址(1) + 寄存器(1) + 值(2)。
+// 寄存器字节最高位置1表示这次读取失败（值无意义），重放时据此注入 NACK。
+#define TRACE_FILE "/trace.bin"
+#define TRACE_VERSION 1
+#define TRACE_HEADER_SIZE 8
+#define TRACE_RECORD_SIZE 8
+#define TRACE_REG_FAILED 0x80
+// 闪存中跟踪文件的上限（约16000条，每个样本3条，250ms间隔下约20分钟）
+#define TRACE_MAX_BYTES 131072
+// 内存中缓冲的记录数，由 loop() 成批写入闪存
+#define TRACE_BUFFER_RECORDS 32
+#define TRACE_MAX_DURATION_MS 3600000UL
+
+struct TraceRecord {
+    uint32_t ms;
+    uint8_t address;
+    uint8_t reg;        // 寄存器号，失败时带 TRACE_REG_FAILED
+    uint16_t value;
+
+    bool failed() const { return (reg & TRACE_REG_FAILED) != 0; }
+    uint8_t registerNumber() const { return reg & ~TRACE_REG_FAILED; }
+};
+
+void encodeTraceHeader(uint8_t* out);
+bool decodeTraceHeader(const uint8_t* in);
+void encodeTraceRecord(const TraceRecord& record, uint8_t* out);
+void decodeTraceRecord(const uint8_t* in, TraceRecord& record);
+
+// 录制到 SPIFFS。record() 只写入内存缓冲，可在 I2C 完成回调中调用；
+// 闪存写入在 loop() 中进行。文件在 start() 打开、stop() 关闭，录制期间不反复打开。
+// 缓冲满而来不及写出的记录计入丢弃
+class TraceRecorder {
+public:
+    TraceRecorder();
+
+    // 开始录制 durationMs 毫秒，覆盖上一次的文件
+    bool start(unsigned long durationMs);
+    void stop();
+    void record(uint8_t address, uint8_t reg, uint16_t value, bool ok);
+
+    // 在loop()中调用：写出缓冲，到时或文件达到上限时停止
+    void loop();
+
+    bool isRecording() const { return recording; }
+    uint32_t getRecords() const { return records; }
+    uint32_t getDropped() const { return dropped; }
+    size_t getBytes() const { return bytes; }
+
+private:
+    File file;
+    uint8_t buffer[TRACE_BUFFER_RECORDS * TRACE_RECORD_SIZE];
+    size_t buffered;
+    bool recording;
+    unsigned long startMillis;
+    unsigned long duration;
+    uint32_t records;
+    uint32_t dropped;
+    size_t bytes;
+
+    void flush();
+};
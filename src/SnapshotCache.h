@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "PowerSample.h"
+#include "PowerCodec.h"
+
+#define SNAPSHOT_BUFFER_SIZE 160
+
+// 最新样本的预序列化缓存。
+// 每个新样本只序列化一次，/power 等读者直接发送缓存的字节，
+// N 个读者只需一次序列化。采用双缓冲：新内容写入非活动缓冲后再切换，
+// 持有上一份指针的读者在下一次切换前仍可安全读取。
+class SnapshotCache {
+public:
+    enum Format {
+        FORMAT_WEB = 0,     // /power：功率单位为W
+        FORMAT_MSGPACK,     // /power（Accept: application/msgpack）：整数定点
+        FORMAT_COUNT
+    };
+
+    SnapshotCache() : seq(0), active(0) {
+        // 尚无采样时返回空对象
+        for (int b = 0; b < 2; b++) {
+            strcpy(buffers[b][FORMAT_WEB], "{}");
+            lengths[b][FORMAT_WEB] = 2;
+            buffers[b][FORMAT_MSGPACK][0] = (char)0x80;  // 空 map
+            lengths[b][FORMAT_MSGPACK] = 1;
+        }
+    }
+
+    // 序列化新样本；与已缓存的序号相同时直接返回
+    void update(const PowerSample& sample);
+
+    // /power 的 JSON：{"seq":N,"channel1":{"current":mA,"voltage":V,"power":W}}，flags 非0时附带，
+    // 返回写入的字节数
+    static size_t encodeJson(const PowerSample& sample, char* out, size_t size);
+
+    const char* data(Format format) const { return buffers[active][format]; }
+    size_t length(Format format) const { return lengths[active][format]; }
+    uint32_t getSeq() const { return seq; }
+
+private:
+    char buffers[2][FORMAT_COUNT][SNAPSHOT_BUFFER_SIZE];
+    size_t lengths[2][FORMAT_COUNT];
+    uint32_t seq;
+    uint8_t active;
+};
+
+inline size_t SnapshotCache::encodeJson(const PowerSample& sample, char* out, size_t size) {
+    StaticJsonDocument<192> doc;
+    doc["seq"] = sample.seq;
+    JsonObject channel = doc.createNestedObject("channel1");
+    channel["current"] = sample.current;
+    channel["voltage"] = sample.voltage;
+    channel["power"] = sample.power / 1000.0;  // 转换为瓦特
+    if (sample.flags) doc["flags"] = sample.flags;
+    return serializeJson(doc, out, size);
+}
+
+inline void SnapshotCache::update(const PowerSample& sample) {
+    if (sample.seq == seq) return;
+
+    uint8_t next = active ^ 1;
+
+    lengths[next][FORMAT_WEB] = encodeJson(sample, buffers[next][FORMAT_WEB], SNAPSHOT_BUFFER_SIZE);
+
+    MsgPackWriter writer((uint8_t*)buffers[next][FORMAT_MSGPACK], SNAPSHOT_BUFFER_SIZE);
+    writeSnapshotMsgPack(writer, sample);
+    lengths[next][FORMAT_MSGPACK] = writer.length();
+
+    // 全部格式写完后再切换，读者看到的始终是同一样本
+    active = next;
+    seq = sample.seq;
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "Telemetry.h"
+#include <time.h>
+#include "Log.h"
+
+PowerTelemetry::PowerTelemetry(PowerMonitor& monitor, PubSubClient& mqtt)
+    : monitor(monitor), mqtt(mqtt), encoding(ENCODING_JSON),
+      batchSize(TELEMETRY_MAX_BATCH), maxLatency(5000),
+      scannedSeq(0), publishedSeq(0), messageCount(0), pendingCount(0),
+      lastReplayMillis(0), replayedCount(0) {
+}
+
+void PowerTelemetry::begin(const Config& config) {
+    // MessagePack 发布到 <topic>/msgpack，订阅方按主题后缀选择编码
+    encoding = config.Encoding == "msgpack" ? ENCODING_MSGPACK : ENCODING_JSON;
+    topic = config.Topic;
+    if (encoding == ENCODING_MSGPACK) {
+        topic += "/msgpack";
+    }
+    replayTopic = topic + "/replay";
+    queue.begin(config.QueueSpill);
+    deadband.configure(config.DeadbandAbs, config.DeadbandRel, config.Heartbeat);
+    int maxBatch = deadband.isEnabled() ? TELEMETRY_MAX_BATCH_EXTREMES : TELEMETRY_MAX_BATCH;
+    batchSize = constrain(config.BatchSize, 1, maxBatch);
+    maxLatency = config.BatchLatency;
+    LOG_INFO("Telemetry: %s to %s, batch %u samples, max latency %lu ms, heartbeat %lu ms",
+                  encoding == ENCODING_MSGPACK ? "msgpack" : "json", topic.c_str(),
+                  (unsigned)batchSize, maxLatency, config.Heartbeat);
+}
+
+bool PowerTelemetry::loop() {
+    if (topic.length() == 0) return false;
+
+    collect();
+    bool online = mqtt.connected();
+
+    // 凑满一批或最早的待发样本超时后发布，离线或发布失败时转入离线队列
+    if (pendingCount > 0 && (pendingCount >= batchSize || millis() - pending[0].ms >= maxLatency)) {
+        if (online && publishPending()) return true;
+        queue.push(pending, pendingExtremes, pendingCount);
+        pendingCount = 0;
+    }
+
+    // 实时数据发布后再限速重放离线队列，避免实时数据被挤占
+    if (online && !queue.isEmpty() && millis() - lastReplayMillis >= TELEMETRY_REPLAY_INTERVAL_MS) {
+        return replay();
+    }
+    return false;
+}
+
+// 将新样本送入死区过滤，需要上报的样本加入待发队列
+void PowerTelemetry::collect() {
+    // 设备侧序号只增不减，若出现回退说明监视器被重建，从头开始
+    if (monitor.getLatestSeq() < scannedSeq) {
+        scannedSeq = 0;
+        publishedSeq = 0;
+    }
+
+    PowerSample chunk[8];
+    while (pendingCount < batchSize) {
+        size_t count = monitor.getSamplesSince(scannedSeq, chunk, 8);
+        if (count == 0) break;
+        for (size_t i = 0; i < count && pendingCount < batchSize; i++) {
+            scannedSeq = chunk[i].seq;
+            if (deadband.filter(chunk[i], pendingExtremes[pendingCount])) {
+                pending[pendingCount++] = chunk[i];
+            }
+        }
+    }
+}
+
+size_t PowerTelemetry::encode(const PowerSample* samples, const PowerExtremes* extremes, size_t count) {
+    if (!deadband.isEnabled()) extremes = nullptr;
+    if (encoding == ENCODING_MSGPACK) {
+        return encodeBatchMsgPack(samples, extremes, count, time(nullptr), millis(),
+                                  payload, sizeof(payload));
+    }
+    return encodeBatchJson(samples, extremes, count, time(nullptr), millis(),
+                           (char*)payload, sizeof(payload));
+}
+
+bool PowerTelemetry::publishPending() {
+    size_t len = encode(pending, pendingExtremes, pendingCount);
+    if (len == 0 || !mqtt.publish(topic.c_str(), payload, len)) {
+        return false;
+    }
+
+    publishedSeq = pending[pendingCount - 1].seq;
+    pendingCount = 0;
+    messageCount++;
+    return true;
+}
+
+// 从离线队列取出最早的一批重放，发布成功后才出队
+bool PowerTelemetry::replay() {
+    lastReplayMillis = millis();
+    size_t maxBatch = deadband.isEnabled() ? TELEMETRY_MAX_BATCH_EXTREMES : TELEMETRY_MAX_BATCH;
+    size_t count = queue.peek(replaySamples, replayExtremes, maxBatch);
+    if (count == 0) return false;
+
+    size_t len = encode(replaySamples, replayExtremes, count);
+    if (len == 0 || !mqtt.publish(replayTopic.c_str(), payload, len)) {
+        return false;
+    }
+
+    queue.pop(count);
+    replayedCount += count;
+    messageCount++;
+    return true;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include "EspSmartWifi.h"
+#include "PowerMonitor.h"
+#include "PowerCodec.h"
+#include "Deadband.h"
+#include "TelemetryQueue.h"
+
+// 单条消息最多打包的样本数，受 MQTT 缓冲区（2048字节）限制；
+// 按变化上报时每个样本附带极值，条数减半
+#define TELEMETRY_MAX_BATCH 32
+#define TELEMETRY_MAX_BATCH_EXTREMES 16
+#define TELEMETRY_PAYLOAD_SIZE 1800
+// 离线队列重放的最小间隔，每次最多一批，实时数据优先
+#define TELEMETRY_REPLAY_INTERVAL_MS 250
+
+// MQTT遥测：从采样环形缓冲中取出尚未发布的样本，经死区过滤后每条消息打包多个样本。
+// 发布过程不访问传感器，也不向串口输出。
+// MQTT断开时样本进入离线队列，恢复连接后限速重放到 <topic>/replay，
+// 样本保留原始 ms，接收方按批次的 ts/ms 换算出原始时间。
+class PowerTelemetry {
+public:
+    PowerTelemetry(PowerMonitor& monitor, PubSubClient& mqtt);
+
+    // 读取批量大小、最大延迟、死区、主题和编码方式，需在配置加载后调用
+    void begin(const Config& config);
+
+    // 在loop()中调用（无论是否联网），凑满一批或最早的待发样本超过最大延迟时发布，
+    // 离线时转入离线队列；发布成功返回true
+    bool loop();
+
+    uint32_t getPublishedSeq() const { return publishedSeq; }
+    uint32_t getMessageCount() const { return messageCount; }
+    uint32_t getReplayedCount() const { return replayedCount; }
+    const TelemetryQueue& getQueue() const { return queue; }
+
+private:
+    PowerMonitor& monitor;
+    PubSubClient& mqtt;
+    String topic;
+    String replayTopic;
+    PayloadEncoding encoding;
+    size_t batchSize;
+    unsigned long maxLatency;
+    Deadband deadband;
+
+    uint32_t scannedSeq;       // 已经过死区过滤的最后一个样本序号
+    uint32_t publishedSeq;     // 已发布的最后一个样本序号
+    uint32_t messageCount;
+
+    // 待发布的样本及其极值
+    PowerSample pending[TELEMETRY_MAX_BATCH];
+    PowerExtremes pendingExtremes[TELEMETRY_MAX_BATCH];
+    size_t pendingCount;
+
+    // 离线队列及重放缓冲
+    TelemetryQueue queue;
+    PowerSample replaySamples[TELEMETRY_MAX_BATCH];
+    PowerExtremes replayExtremes[TELEMETRY_MAX_BATCH];
+    unsigned long lastReplayMillis;
+    uint32_t replayedCount;
+
+    uint8_t payload[TELEMETRY_PAYLOAD_SIZE];
+
+    void collect();
+    bool publishPending();
+    bool replay();
+    size_t encode(const PowerSample* samples, const PowerExtremes* extremes, size_t count);
+};
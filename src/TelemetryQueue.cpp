@@ -0,0 +1,119 @@
+#include "TelemetryQueue.h"
+
+TelemetryQueue::TelemetryQueue()
+    : ramHead(0), ramCount(0), spill(false), spillOffset(0), spillSize(0), dropped(0) {
+}
+
+void TelemetryQueue::begin(bool spill) {
+    this->spill = spill;
+    if (SPIFFS.exists(TELEMETRY_SPILL_FILE)) {
+        SPIFFS.remove(TELEMETRY_SPILL_FILE);
+    }
+    spillOffset = 0;
+    spillSize = 0;
+}
+
+void TelemetryQueue::push(const PowerSample* samples, const PowerExtremes* extremes, size_t count) {
+    size_t i = 0;
+    // 闪存中已有数据时必须追加到闪存，否则会越过更早的样本
+    for (; i < count && (!spill || (spillCount() == 0 && ramCount < TELEMETRY_QUEUE_SIZE)); i++) {
+        Record record;
+        record.sample = samples[i];
+        record.extremes = extremes[i];
+        pushRam(record);
+    }
+    if (i < count) {
+        spillRecords(samples + i, extremes + i, count - i);
+    }
+}
+
+void TelemetryQueue::pushRam(const Record& record) {
+    if (ramCount < TELEMETRY_QUEUE_SIZE) {
+        ram[(ramHead + ramCount) % TELEMETRY_QUEUE_SIZE] = record;
+        ramCount++;
+        return;
+    }
+    // 只用内存时覆盖最旧的样本
+    ram[ramHead] = record;
+    ramHead = (ramHead + 1) % TELEMETRY_QUEUE_SIZE;
+    dropped++;
+}
+
+void TelemetryQueue::spillRecords(const PowerSample* samples, const PowerExtremes* extremes, size_t count) {
+    // 超出文件上限的新样本直接丢弃
+    size_t room = (TELEMETRY_SPILL_MAX_BYTES - spillSize) / sizeof(Record);
+    if (count > room) {
+        dropped += count - room;
+        count = room;
+    }
+    if (count == 0) return;
+
+    // 整批只打开一次文件，按块写入，避免每条记录一次打开/关闭
+    File file = SPIFFS.open(TELEMETRY_SPILL_FILE, "a");
+    if (!file) {
+        dropped += count;
+        return;
+    }
+    Record chunk[TELEMETRY_SPILL_CHUNK];
+    size_t done = 0;
+    while (done < count) {
+        size_t n = count - done < TELEMETRY_SPILL_CHUNK ? count - done : TELEMETRY_SPILL_CHUNK;
+        for (size_t i = 0; i < n; i++) {
+            chunk[i].sample = samples[done + i];
+            chunk[i].extremes = extremes[done + i];
+        }
+        size_t bytes = n * sizeof(Record);
+        if (file.write((const uint8_t*)chunk, bytes) != bytes) break;
+        spillSize += bytes;
+        done += n;
+    }
+    dropped += count - done;
+    file.close();
+}
+
+size_t TelemetryQueue::peek(PowerSample* samples, PowerExtremes* extremes, size_t maxCount) {
+    size_t count = 0;
+    for (; count < maxCount && count < ramCount; count++) {
+        const Record& record = ram[(ramHead + count) % TELEMETRY_QUEUE_SIZE];
+        samples[count] = record.sample;
+        extremes[count] = record.extremes;
+    }
+    // 内存队列已取完才读取闪存，保持顺序
+    if (count == ramCount && count < maxCount && spillCount() > 0) {
+        count += peekSpill(samples + count, extremes + count, maxCount - count);
+    }
+    return count;
+}
+
+size_t TelemetryQueue::peekSpill(PowerSample* samples, PowerExtremes* extremes, size_t maxCount) {
+    File file = SPIFFS.open(TELEMETRY_SPILL_FILE, "r");
+    if (!file) return 0;
+    size_t count = 0;
+    if (file.seek(spillOffset, SeekSet)) {
+        Record record;
+        while (count < maxCount && file.read((uint8_t*)&record, sizeof(Record)) == sizeof(Record)) {
+            samples[count] = record.sample;
+            extremes[count] = record.extremes;
+            count++;
+        }
+    }
+    file.close();
+    return count;
+}
+
+void TelemetryQueue::pop(size_t count) {
+    size_t fromRam = count < ramCount ? count : ramCount;
+    ramHead = (ramHead + fromRam) % TELEMETRY_QUEUE_SIZE;
+    ramCount -= fromRam;
+    count -= fromRam;
+
+    if (count > 0) {
+        spillOffset += count * sizeof(Record);
+        // 文件全部读完后删除，下次溢出重新开始
+        if (spillOffset >= spillSize) {
+            SPIFFS.remove(TELEMETRY_SPILL_FILE);
+            spillOffset = 0;
+            spillSize = 0;
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include "PowerSample.h"
+
+// 内存中最多缓存的离线样本数（每个约48字节）
+#define TELEMETRY_QUEUE_SIZE 64
+// 溢出到闪存时的文件及其上限（约1300个样本）
+#define TELEMETRY_SPILL_FILE "/telemetry.q"
+#define TELEMETRY_SPILL_MAX_BYTES 65536
+// 写闪存时在栈上攒够这么多条再写一次
+#define TELEMETRY_SPILL_CHUNK 8
+
+// 离线遥测队列：MQTT不可用时保存未发布的样本（连同极值），恢复连接后按原顺序重放。
+// 先进先出：内存队列保存最早的样本，内存满后新样本追加到闪存文件，
+// 闪存中有数据时新样本一律写入闪存，保证顺序。
+// 只用内存时队列满则丢弃最旧的样本；闪存文件满时丢弃新样本。
+// 丢失的样本不影响电能统计，累计电能随每个样本一起保存。
+class TelemetryQueue {
+public:
+    TelemetryQueue();
+
+    // spill 为true时允许溢出到闪存，上次运行遗留的文件会被删除（millis()已失效）
+    void begin(bool spill);
+
+    void push(const PowerSample* samples, const PowerExtremes* extremes, size_t count);
+
+    // 按从旧到新的顺序拷贝最多 maxCount 个样本，不出队，返回实际个数
+    size_t peek(PowerSample* samples, PowerExtremes* extremes, size_t maxCount);
+
+    // 发布成功后移除 peek 得到的前 count 个样本
+    void pop(size_t count);
+
+    bool isEmpty() const { return size() == 0; }
+    size_t size() const { return ramCount + spillCount(); }
+    size_t spillCount() const { return (spillSize - spillOffset) / sizeof(Record); }
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    struct Record {
+        PowerSample sample;
+        PowerExtremes extremes;
+    };
+
+    Record ram[TELEMETRY_QUEUE_SIZE];
+    size_t ramHead;         // 最旧样本的位置
+    size_t ramCount;
+
+    bool spill;
+    size_t spillOffset;     // 闪存文件中下一个未读记录的偏移
+    size_t spillSize;       // 闪存文件的长度
+    uint32_t dropped;
+
+    void pushRam(const Record& record);
+    void spillRecords(const PowerSample* samples, const PowerExtremes* extremes, size_t count);
+    size_t peekSpill(PowerSample* samples, PowerExtremes* extremes, size_t maxCount);
+};
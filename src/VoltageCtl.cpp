@@ -1,11 +1,13 @@
 #include "VoltageCtl.h"
+#include <ArduinoJson.h>
+#include "Log.h"
 
-VoltageCtl::VoltageCtl() : currentVoltage(VOLTAGE_5V) {
+VoltageCtl::VoltageCtl() : currentVoltage(VOLTAGE_5V), lastChangeMillis(0) {
     // 初始化引脚
     pinMode(PD_CFG1, OUTPUT);
     pinMode(PD_CFG2, OUTPUT);
     pinMode(PD_CFG3, OUTPUT);
-    Serial.println("VoltageCtl initialized with 5V");
+    LOG_DEBUG("VoltageCtl initialized with 5V");
 }
 
 void VoltageCtl::begin() {
@@ -19,42 +21,42 @@ void VoltageCtl::begin() {
 }
 
 bool VoltageCtl::setVoltage(uint8_t level) {
-    Serial.printf("Setting voltage level: %d\n", level);
+    LOG_DEBUG("Setting voltage level: %d", level);
     
     // 检查电压等级是否有效
     if (level > VOLTAGE_20V) {
-        Serial.println("Invalid voltage level");
+        LOG_WARN("Invalid voltage level %d", level);
         return false;
     }
 
     // 根据电压等级设置PD控制引脚
     switch (level) {
         case VOLTAGE_5V:
-            Serial.println("Setting 5V: CFG1=1, CFG2=1, CFG3=1");
+            LOG_DEBUG("Setting 5V: CFG1=1, CFG2=1, CFG3=1");
             digitalWrite(PD_CFG1, HIGH);  // 1
             digitalWrite(PD_CFG2, HIGH);   // -
             digitalWrite(PD_CFG3, HIGH);   // -
             break;
         case VOLTAGE_9V:
-            Serial.println("Setting 9V: CFG1=0, CFG2=0, CFG3=0");
+            LOG_DEBUG("Setting 9V: CFG1=0, CFG2=0, CFG3=0");
             digitalWrite(PD_CFG1, LOW);   // 0
             digitalWrite(PD_CFG2, LOW);   // 0
             digitalWrite(PD_CFG3, LOW);   // 0
             break;
         case VOLTAGE_12V:
-            Serial.println("Setting 12V: CFG1=0, CFG2=0, CFG3=1");
+            LOG_DEBUG("Setting 12V: CFG1=0, CFG2=0, CFG3=1");
             digitalWrite(PD_CFG1, LOW);   // 0
             digitalWrite(PD_CFG2, LOW);   // 0
             digitalWrite(PD_CFG3, HIGH);  // 1
             break;
         case VOLTAGE_15V:
-            Serial.println("Setting 15V: CFG1=0, CFG2=1, CFG3=1");
+            LOG_DEBUG("Setting 15V: CFG1=0, CFG2=1, CFG3=1");
             digitalWrite(PD_CFG1, LOW);   // 0
             digitalWrite(PD_CFG2, HIGH);  // 1
             digitalWrite(PD_CFG3, HIGH);  // 1
             break;
         case VOLTAGE_20V:
-            Serial.println("Setting 20V: CFG1=0, CFG2=1, CFG3=0");
+            LOG_DEBUG("Setting 20V: CFG1=0, CFG2=1, CFG3=0");
             digitalWrite(PD_CFG1, LOW);   // 0
             digitalWrite(PD_CFG2, HIGH);  // 1
             digitalWrite(PD_CFG3, LOW);   // 0
@@ -62,16 +64,38 @@ bool VoltageCtl::setVoltage(uint8_t level) {
     }
 
     currentVoltage = level;
-    delay(1000); // 延时1秒，等待电压稳定
+    // 不再阻塞等待电压稳定，由 isSettling() 报告稳定期
+    lastChangeMillis = millis();
     saveConfig(); // 保存配置
-    Serial.print("Voltage set to: ");
-    Serial.println(level);
+    LOG_INFO("Voltage set to level %d (%dV)", level, getTargetVolts());
     return true;
 }
 
+int VoltageCtl::getTargetVolts() const {
+    switch (currentVoltage) {
+        case VOLTAGE_5V:  return 5;
+        case VOLTAGE_9V:  return 9;
+        case VOLTAGE_12V: return 12;
+        case VOLTAGE_15V: return 15;
+        case VOLTAGE_20V: return 20;
+        default: return 0;
+    }
+}
+
+bool VoltageCtl::setTargetVolts(int volts) {
+    switch (volts) {
+        case 5:  return setVoltage(VOLTAGE_5V);
+        case 9:  return setVoltage(VOLTAGE_9V);
+        case 12: return setVoltage(VOLTAGE_12V);
+        case 15: return setVoltage(VOLTAGE_15V);
+        case 20: return setVoltage(VOLTAGE_20V);
+        default: return false;
+    }
+}
+
 bool VoltageCtl::saveConfig() {
     if (!SPIFFS.begin()) {
-        Serial.println("Failed to mount SPIFFS");
+        LOG_ERROR("Failed to mount SPIFFS");
         return false;
     }
 
@@ -82,29 +106,29 @@ bool VoltageCtl::saveConfig() {
     // 直接写入文件
     File configFile = SPIFFS.open("/vol-config.json", "w");
     if (!configFile) {
-        Serial.println("Failed to open vol-config.json for writing");
+        LOG_ERROR("Failed to open vol-config.json for writing");
         return false;
     }
 
     if (serializeJson(doc, configFile) == 0) {
-        Serial.println("Failed to write to vol-config.json");
+        LOG_ERROR("Failed to write to vol-config.json");
         return false;
     }
 
     configFile.close();
-    Serial.println("Voltage configuration saved");
+    LOG_DEBUG("Voltage configuration saved");
     return true;
 }
 
 bool VoltageCtl::loadConfig() {
     if (!SPIFFS.begin()) {
-        Serial.println("Failed to mount SPIFFS");
+        LOG_ERROR("Failed to mount SPIFFS");
         return false;
     }
 
     File configFile = SPIFFS.open("/vol-config.json", "r");
     if (!configFile) {
-        Serial.println("Failed to open vol-config.json");
+        LOG_WARN("Failed to open vol-config.json");
         return false;
     }
 
@@ -113,7 +137,7 @@ bool VoltageCtl::loadConfig() {
     configFile.close();
 
     if (error) {
-        Serial.println("Failed to parse vol-config.json");
+        LOG_WARN("Failed to parse vol-config.json");
         return false;
     }
 
@@ -121,11 +145,11 @@ bool VoltageCtl::loadConfig() {
         uint8_t savedVoltage = doc["currentVol"];
         if (savedVoltage <= VOLTAGE_20V) {
             currentVoltage = savedVoltage;
-            Serial.printf("Loaded voltage configuration: %d\n", currentVoltage);
+            LOG_INFO("Loaded voltage configuration: %d", currentVoltage);
             return true;
         }
     }
 
-    Serial.println("No valid voltage configuration found");
+    LOG_WARN("No valid voltage configuration found");
     return false;
 } 
\ No newline at end of file
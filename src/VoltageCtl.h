@@ -2,7 +2,6 @@
 
 #include <Arduino.h>
 #include <FS.h>
-#include <ArduinoJson.h>
 
 // PD电压档位定义
 #define VOLTAGE_5V  0
@@ -22,10 +21,16 @@ public:
     void begin();
     bool setVoltage(uint8_t level);
     uint8_t getCurrentVoltage() const { return currentVoltage; }
+    int getTargetVolts() const;
+    // 按伏特数（5/9/12/15/20）设置电压，不支持的电压返回false
+    bool setTargetVolts(int volts);
+    // 切换电压后的稳定期内返回true，此时实测电压尚未到达目标值
+    bool isSettling() const { return millis() - lastChangeMillis < VOLTAGE_CHANGE_DELAY; }
     bool saveConfig();
     bool loadConfig();
 
 private:
     uint8_t currentVoltage;
+    unsigned long lastChangeMillis;
     static const unsigned long VOLTAGE_CHANGE_DELAY = 1000; // 1秒延时
 }; 
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "WebServer.h"
 #include <ArduinoJson.h>
 #include <FS.h>  // 添加SPIFFS支持
+#include "Log.h"
+#include "BenchSuite.h"
 
 #define BUILD_DATE_STR __DATE__ " " __TIME__
 
@@ -707,27 +709,44 @@ const char WebServer::INDEX_HTML[] PROGMEM = R"rawliteral(
             voltage: [],
             power: []
         };
-        const maxDataPoints = 60;
+        const maxDataPoints = 240;
         let currentChannelIndex = 0;
         let currentDataType = 'power';
+        let lastSeq = 0;
 
-        function updatePowerData() {
-            fetch('/power')
+        // 一次请求获取全部仪表盘状态，并增量获取上次之后的全部样本
+        function updateSnapshot() {
+            fetch('/api/snapshot?since=' + lastSeq)
                 .then(response => response.json())
                 .then(data => {
-                    const channel = data['channel1'];
-                    if (channel) {
-                        document.getElementById('power1').textContent = channel.power.toFixed(2) + ' W';
-                        document.getElementById('current1').textContent = channel.current.toFixed(2) + ' mA';
-                        document.getElementById('voltage1').textContent = channel.voltage.toFixed(2) + ' V';
-                        
-                        // 如果图表正在显示，更新图表数据
-                        if (powerChart && currentChannelIndex === 0) {
-                            updateChartData(channel);
-                        }
+                    // 设备重启后序号从头开始
+                    if (data.seq < lastSeq) {
+                        lastSeq = 0;
+                        return;
+                    }
+
+                    updateVoltageDisplay(data.voltage, data.settling);
+
+                    const samples = data.samples;
+                    if (!samples || samples.length === 0) return;
+                    lastSeq = samples[samples.length - 1][0];
+
+                    const latest = samples[samples.length - 1];
+                    document.getElementById('power1').textContent = (latest[4] / 1000).toFixed(2) + ' W';
+                    document.getElementById('current1').textContent = latest[3].toFixed(2) + ' mA';
+                    document.getElementById('voltage1').textContent = latest[2].toFixed(2) + ' V';
+
+                    // 如果图表正在显示，更新图表数据
+                    if (powerChart && currentChannelIndex === 0) {
+                        const nowMs = Date.now();
+                        samples.forEach(s => {
+                            const label = new Date(nowMs - (data.now - s[1])).toLocaleTimeString();
+                            appendChartData(label, { voltage: s[2], current: s[3], power: s[4] / 1000 });
+                        });
+                        refreshChart();
                     }
                 })
-                .catch(error => console.error('Error updating power data:', error));
+                .catch(error => console.error('Error updating snapshot:', error));
         }
 
         // 显示功率图表
@@ -790,26 +809,23 @@ const char WebServer::INDEX_HTML[] PROGMEM = R"rawliteral(
             }
         }
 
-        function updateChartData(data) {
-            if (!powerChart) return;
-
-            const timestamp = new Date().toLocaleTimeString();
-            
-            // 添加新数据
-            chartData.labels.push(timestamp);
+        function appendChartData(label, data) {
+            chartData.labels.push(label);
             chartData.current.push(data.current);
             chartData.voltage.push(data.voltage);
             chartData.power.push(data.power);
 
-            // 保持最近60个数据点
+            // 保持最近 maxDataPoints 个数据点
             if (chartData.labels.length > maxDataPoints) {
                 chartData.labels.shift();
                 chartData.current.shift();
                 chartData.voltage.shift();
                 chartData.power.shift();
             }
+        }
 
-            // 更新图表
+        function refreshChart() {
+            if (!powerChart) return;
             powerChart.data.labels = chartData.labels;
             powerChart.data.datasets[0].data = chartData[currentDataType];
             powerChart.update();
@@ -839,13 +855,12 @@ const char WebServer::INDEX_HTML[] PROGMEM = R"rawliteral(
             });
 
             // 初始更新
-            updatePowerData();
+            updateSnapshot();
             updateBuildDate();
-            checkVoltage();
         });
 
         // 定期更新数据
-        setInterval(updatePowerData, 1000);   // 每秒更新电源数据
+        setInterval(updateSnapshot, 1000);   // 每秒更新全部状态
 
         // 更新构建日期
         function updateBuildDate() {
@@ -874,36 +889,30 @@ const char WebServer::INDEX_HTML[] PROGMEM = R"rawliteral(
                 .catch(error => {
                     console.error('Error setting voltage:', error);
                     // If error occurs, recheck voltage to ensure correct display
-                    checkVoltage();
+                    updateSnapshot();
                 });
         }
 
-        function checkVoltage() {
-            fetch('/voltage')
-                .then(response => response.json())
-                .then(data => {
-                    if (data.voltage) {
-                        const voltage = data.voltage;
-                        document.getElementById('currentVoltage').textContent = voltage + 'V';
-                        // Update radio button selection
-                        const radio = document.querySelector(`input[name="voltage"][value="${voltage}"]`);
-                        if (radio) {
-                            radio.checked = true;
-                        }
-                    }
-                })
-                .catch(error => console.error('Error checking voltage:', error));
+        function updateVoltageDisplay(voltage, settling) {
+            if (voltage) {
+                document.getElementById('currentVoltage').textContent = voltage + 'V' + (settling ? ' (settling)' : '');
+                // Update radio button selection
+                const radio = document.querySelector(`input[name="voltage"][value="${voltage}"]`);
+                if (radio) {
+                    radio.checked = true;
+                }
+            }
         }
-
-        // Add voltage check to periodic updates
-        setInterval(checkVoltage, 1000);  // Check voltage every second
     </script>
 </body>
 </html>
 )rawliteral";
 
-WebServer::WebServer(EspSmartWifi& wifi, EasyLed& led, Display& display, VoltageCtl &voltagectl) 
-    : server(80), wifi(wifi), led(led), display(display), voltageCtl(voltagectl) {
+WebServer::WebServer(EspSmartWifi& wifi, EasyLed& led, Display& display, VoltageCtl &voltagectl, PowerMonitor &powermonitor,
+                     const WebServerContext& context)
+    : server(80), wifi(wifi), led(led), display(display), voltageCtl(voltagectl), powerMonitor(powermonitor),
+      mqttConnection(context.mqttConnection), telemetry(context.telemetry), scheduler(context.scheduler),
+      i2cBus(context.i2cBus), i2cPort(context.i2cPort), traceRecorder(context.traceRecorder) {
     Serial.println("\n=== WebServer Initialization ===");
     
     // 初始化SPIFFS
@@ -929,23 +938,11 @@ WebServer::WebServer(EspSmartWifi& wifi, EasyLed& led, Display& display, Voltage
     pinMode(BUTTON_PIN, INPUT_PULLUP);
     Serial.println("Button pin initialized with internal pull-up");
     
-    // 初始化PowerMonitor
-    Serial.println("\nInitializing PowerMonitor...");
-    if (initPowerMonitor()) {
-        Serial.println("SUCCESS: PowerMonitor initialized successfully");
-    } else {
-        Serial.println("ERROR: PowerMonitor initialization failed!");
-    }
-    
-
+    // PowerMonitor 与 main.cpp 共用同一实例，由 setup() 负责初始化
     
     Serial.println("=== WebServer Initialization Complete ===\n");
 }
 
-bool WebServer::initPowerMonitor() {
-    return powerMonitor.begin();
-}
-
 void WebServer::begin() {
     // 先停止服务器
     server.stop();
@@ -971,6 +968,15 @@ void WebServer::begin() {
     
     server.on("/status", HTTP_GET, [this]() { handleStatus(); });
     server.on("/power", HTTP_GET, [this]() { handlePower(); });
+    server.on("/power/since", HTTP_GET, [this]() { handlePowerSince(); });
+    server.on("/api/snapshot", HTTP_GET, [this]() { handleSnapshot(); });
+    server.on("/logs", HTTP_GET, [this]() { handleLogs(); });
+    server.on("/metrics", HTTP_GET, [this]() { handleMetrics(); });
+    server.on("/metrics/budget", HTTP_POST, [this]() { handleMetricsBudget(); });
+    server.on("/trace", HTTP_GET, [this]() { handleTrace(); });
+    server.on("/trace", HTTP_POST, [this]() { handleTraceStart(); });
+    server.on("/trace/data", HTTP_GET, [this]() { handleTraceData(); });
+    server.on("/bench", HTTP_GET, [this]() { handleBench(); });
     server.on("/voltage", HTTP_GET, [this]() { handleVoltage(); });  // Add voltage endpoint
     server.on("/restart", HTTP_POST, [this]() { handleRestart(); });
     server.on("/upgrade", HTTP_GET, [this]() { handleUpgrade(); });
@@ -979,6 +985,10 @@ void WebServer::begin() {
 
     
     server.onNotFound([this]() { handleNotFound(); });
+
+    // 需要读取 Accept 头以协商 MessagePack 编码
+    const char* headerKeys[] = {"Accept"};
+    server.collectHeaders(headerKeys, 1);
     
     // 启动服务器
     server.begin();
@@ -999,40 +1009,434 @@ void WebServer::stop() {
 }
 
 
+// 客户端通过 Accept 头请求 MessagePack 编码
+bool WebServer::wantsMsgPack() {
+    return server.header("Accept").indexOf("msgpack") >= 0;
+}
+
 void WebServer::handlePower() {
-    StaticJsonDocument<512> doc;
-    
-    if (powerMonitor.isInitialized()) {
-        for (int i = 0; i < 3; i++) {
-            JsonObject channel = doc.createNestedObject("channel" + String(i + 1));
-            channel["current"] = powerMonitor.getCurrent_mA();
-            channel["voltage"] = powerMonitor.getBusVoltage_V();
-            channel["power"] = powerMonitor.getPower_mW() / 1000.0;  // 转换为瓦特
+    // 直接发送最新样本的预序列化结果，不再为每个请求读取传感器和序列化
+    const SnapshotCache& snapshot = powerMonitor.getSnapshot();
+    if (wantsMsgPack()) {
+        server.send(200, "application/msgpack",
+                    snapshot.data(SnapshotCache::FORMAT_MSGPACK),
+                    snapshot.length(SnapshotCache::FORMAT_MSGPACK));
+        return;
+    }
+    server.send(200, "application/json",
+                snapshot.data(SnapshotCache::FORMAT_WEB),
+                snapshot.length(SnapshotCache::FORMAT_WEB));
+}
+
+// 返回序号大于 seq 的全部缓存样本，客户端据此补齐两次轮询之间的数据。
+// 每个样本为 [seq, ms, 电压V, 电流mA, 功率mW]；若 samples 中第一个 seq
+// 不等于请求的 seq+1，说明有样本已被环形缓冲覆盖。
+void WebServer::handlePowerSince() {
+    uint32_t seq = 0;
+    if (server.hasArg("seq")) {
+        seq = strtoul(server.arg("seq").c_str(), nullptr, 10);
+    }
+
+    if (wantsMsgPack()) {
+        sendSamplesSinceMsgPack(seq);
+        return;
+    }
+
+    // 分批拷贝并以 chunked 方式发送，避免为整个响应分配大块内存
+    char buffer[512];
+    int len = snprintf(buffer, sizeof(buffer), "{\"seq\":%lu,\"oldest\":%lu,\"now\":%lu,\"samples\":[",
+                       (unsigned long)powerMonitor.getLatestSeq(),
+                       (unsigned long)powerMonitor.getOldestSeq(),
+                       (unsigned long)millis());
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/json", "");
+
+    len = sendSamplesSince(seq, buffer, sizeof(buffer), len);
+    len += snprintf(buffer + len, sizeof(buffer) - len, "]}");
+    server.sendContent(buffer, len);
+    server.sendContent("");
+}
+
+// /logs?since=N：返回序号大于 N 的日志记录，
+// {"seq":最新序号,"oldest":最旧序号,"logs":[[seq,ms,"级别","文本"],...]}
+void WebServer::handleLogs() {
+    uint32_t since = 0;
+    if (server.hasArg("since")) {
+        since = strtoul(server.arg("since").c_str(), nullptr, 10);
+    }
+
+    char buffer[512];
+    int len = snprintf(buffer, sizeof(buffer), "{\"seq\":%lu,\"oldest\":%lu,\"logs\":[",
+                       (unsigned long)Log::getLatestSeq(), (unsigned long)Log::getOldestSeq());
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/json", "");
+
+    // 只发送请求开始时已有的记录，避免发送过程中产生的日志让响应无限延长
+    uint32_t latest = Log::getLatestSeq();
+    LogCursor cursor;
+    Log::seek(cursor, since);
+    LogEntry entry;
+    char text[LOG_LINE_SIZE];
+    bool first = true;
+    while (cursor.seq <= latest && Log::next(cursor, entry, text, sizeof(text))) {
+        // 缓冲放不下一条最长的记录时先发送
+        if (len + LOG_LINE_SIZE * 2 > (int)sizeof(buffer)) {
+            server.sendContent(buffer, len);
+            len = 0;
+        }
+        if (!first) buffer[len++] = ',';
+        size_t n = Log::toJson(entry, text, buffer + len, sizeof(buffer) - len);
+        if (n == 0) {
+            // 转义后仍放不下，跳过这条记录
+            if (!first) len--;
+            continue;
+        }
+        len += n;
+        first = false;
+    }
+    len += snprintf(buffer + len, sizeof(buffer) - len, "]}");
+    server.sendContent(buffer, len);
+    server.sendContent("");
+}
+
+// Prometheus 文本格式的运行指标，耗时单位为μs，窗口统计为最近一个完整的10秒窗口
+void WebServer::handleMetrics() {
+    char buffer[768];
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/plain; version=0.0.4", "");
+
+    const LatencyStats& loop = scheduler.getLoopLatency();
+    int len = snprintf(buffer, sizeof(buffer),
+                       "esp_uptime_seconds %lu\n"
+                       "esp_scheduler_idle_total %lu\n"
+                       "esp_loop_interval_us{stat=\"mean\"} %lu\n"
+                       "esp_loop_interval_us{stat=\"p99\"} %lu\n"
+                       "esp_loop_interval_us{stat=\"max\"} %lu\n"
+                       "esp_loop_interval_max_us %lu\n"
+                       "esp_display_flushes_total %lu\n"
+                       "esp_display_bytes_total %lu\n"
+                       "esp_i2c_utilization_ratio %u.%03u\n"
+                       "esp_i2c_recoveries_total %lu\n"
+                       "esp_sensor_failed_samples_total %lu\n"
+                       "esp_sensor_reinits_total %lu\n"
+                       "esp_sensor_sample_us{stat=\"mean\"} %lu\n"
+                       "esp_sensor_sample_us{stat=\"p99\"} %lu\n"
+                       "esp_sensor_sample_us{stat=\"max\"} %lu\n",
+                       millis() / 1000, (unsigned long)scheduler.getIdleCount(),
+                       (unsigned long)loop.getMean(), (unsigned long)loop.getP99(),
+                       (unsigned long)loop.getMax(), (unsigned long)loop.getLifetimeMax(),
+                       (unsigned long)display.getFlushCount(), (unsigned long)display.getFlushBytes(),
+                       (unsigned)(i2cBus.getUtilization() / 1000), (unsigned)(i2cBus.getUtilization() % 1000),
+                       (unsigned long)i2cBus.getRecoveries(), (unsigned long)powerMonitor.getFailedSamples(),
+                       (unsigned long)powerMonitor.getReinits(),
+                       (unsigned long)powerMonitor.getSampleLatency().getMean(),
+                       (unsigned long)powerMonitor.getSampleLatency().getP99(),
+                       (unsigned long)powerMonitor.getSampleLatency().getMax());
+    server.sendContent(buffer, len);
+
+    len = snprintf(buffer, sizeof(buffer),
+                   "esp_heap_free_bytes %lu\n"
+                   "esp_heap_free_min_bytes %lu\n"
+                   "esp_heap_max_block_bytes %lu\n"
+                   "esp_heap_max_block_min_bytes %lu\n"
+                   "esp_heap_fragmentation_percent %u\n"
+                   "esp_heap_fragmentation_max_percent %u\n"
+                   "esp_heap_low_events_total %lu\n",
+                   (unsigned long)HeapMonitor::getFree(), (unsigned long)HeapMonitor::getMinFree(),
+                   (unsigned long)HeapMonitor::getMaxBlock(), (unsigned long)HeapMonitor::getMinMaxBlock(),
+                   (unsigned)HeapMonitor::getFragmentation(), (unsigned)HeapMonitor::getMaxFragmentation(),
+                   (unsigned long)HeapMonitor::getLowEvents());
+    server.sendContent(buffer, len);
+
+    for (int i = 0; i < HEAP_SITE_COUNT; i++) {
+        const char* name = HeapMonitor::siteName((HeapSite)i);
+        const HeapSiteStats& site = HeapMonitor::getSite((HeapSite)i);
+        len = snprintf(buffer, sizeof(buffer),
+                       "esp_heap_site_calls_total{site=\"%s\"} %lu\n"
+                       "esp_heap_site_peak_bytes{site=\"%s\"} %lu\n"
+                       "esp_heap_site_retained_bytes_total{site=\"%s\"} %lu\n",
+                       name, (unsigned long)site.calls,
+                       name, (unsigned long)site.peakBytes,
+                       name, (unsigned long)site.retainedBytes);
+        server.sendContent(buffer, len);
+    }
+
+    for (size_t i = 0; i < scheduler.getTaskCount(); i++) {
+        const SchedulerTask& task = scheduler.getTask(i);
+        const LatencyStats& latency = task.latency;
+        len = snprintf(buffer, sizeof(buffer),
+                       "esp_task_runs_total{task=\"%s\"} %lu\n"
+                       "esp_task_overruns_total{task=\"%s\"} %lu\n"
+                       "esp_task_budget_us{task=\"%s\"} %lu\n"
+                       "esp_task_latency_us{task=\"%s\",stat=\"mean\"} %lu\n"
+                       "esp_task_latency_us{task=\"%s\",stat=\"p99\"} %lu\n"
+                       "esp_task_latency_us{task=\"%s\",stat=\"max\"} %lu\n"
+                       "esp_task_latency_max_us{task=\"%s\"} %lu\n",
+                       task.name, (unsigned long)task.runs,
+                       task.name, (unsigned long)task.overruns,
+                       task.name, (unsigned long)task.budget,
+                       task.name, (unsigned long)latency.getMean(),
+                       task.name, (unsigned long)latency.getP99(),
+                       task.name, (unsigned long)latency.getMax(),
+                       task.name, (unsigned long)latency.getLifetimeMax());
+        server.sendContent(buffer, len);
+    }
+
+    for (size_t i = 0; i < i2cBus.getDeviceCount(); i++) {
+        const I2cDevice& dev = i2cBus.getDevice(i);
+        len = snprintf(buffer, sizeof(buffer),
+                       "esp_i2c_transactions_total{device=\"%s\"} %lu\n"
+                       "esp_i2c_bytes_total{device=\"%s\"} %lu\n"
+                       "esp_i2c_deferred_total{device=\"%s\"} %lu\n"
+                       "esp_i2c_errors_total{device=\"%s\"} %lu\n"
+                       "esp_i2c_retries_total{device=\"%s\"} %lu\n"
+                       "esp_i2c_latency_us{device=\"%s\",stat=\"mean\"} %lu\n"
+                       "esp_i2c_latency_us{device=\"%s\",stat=\"p99\"} %lu\n"
+                       "esp_i2c_latency_us{device=\"%s\",stat=\"max\"} %lu\n",
+                       dev.name, (unsigned long)dev.transactions,
+                       dev.name, (unsigned long)dev.bytes,
+                       dev.name, (unsigned long)dev.deferred,
+                       dev.name, (unsigned long)dev.errors,
+                       dev.name, (unsigned long)dev.retries,
+                       dev.name, (unsigned long)dev.latency.getMean(),
+                       dev.name, (unsigned long)dev.latency.getP99(),
+                       dev.name, (unsigned long)dev.latency.getMax());
+        server.sendContent(buffer, len);
+    }
+    server.sendContent("");
+}
+
+// POST /metrics/budget（task=web&us=20000）：运行时调整任务预算，重启后恢复默认
+void WebServer::handleMetricsBudget() {
+    if (!server.hasArg("task") || !server.hasArg("us")) {
+        server.send(400, "text/plain", "Missing parameters");
+        return;
+    }
+    uint32_t budget = strtoul(server.arg("us").c_str(), nullptr, 10);
+    if (!scheduler.setBudget(server.arg("task").c_str(), budget)) {
+        server.send(404, "text/plain", "Unknown task");
+        return;
+    }
+    server.send(200, "text/plain", "OK");
+}
+
+// 传感器跟踪录制状态
+void WebServer::handleTrace() {
+    char buffer[160];
+    snprintf(buffer, sizeof(buffer),
+             "{\"recording\":%s,\"records\":%lu,\"dropped\":%lu,\"bytes\":%lu}",
+             traceRecorder.isRecording() ? "true" : "false", (unsigned long)traceRecorder.getRecords(),
+             (unsigned long)traceRecorder.getDropped(), (unsigned long)traceRecorder.getBytes());
+    server.send(200, "application/json", buffer);
+}
+
+// POST /trace?seconds=N 开始录制N秒（覆盖上一次的跟踪），POST /trace?stop=1 提前停止
+void WebServer::handleTraceStart() {
+    if (server.hasArg("stop")) {
+        traceRecorder.stop();
+        handleTrace();
+        return;
+    }
+    if (!server.hasArg("seconds")) {
+        server.send(400, "text/plain", "Missing parameters");
+        return;
+    }
+    unsigned long seconds = strtoul(server.arg("seconds").c_str(), nullptr, 10);
+    if (seconds == 0 || !traceRecorder.start(seconds * 1000)) {
+        server.send(500, "text/plain", "Cannot start trace");
+        return;
+    }
+    handleTrace();
+}
+
+// 下载跟踪文件，录制中的文件也可下载（不含尚在内存中的记录）
+void WebServer::handleTraceData() {
+    File file = SPIFFS.open(TRACE_FILE, "r");
+    if (!file) {
+        server.send(404, "text/plain", "No trace");
+        return;
+    }
+    server.sendHeader("Content-Disposition", "attachment; filename=trace.bin");
+    server.streamFile(file, "application/octet-stream");
+    file.close();
+}
+
+// /bench 的输出状态：逐个用例以分块发送，不在内存中积累结果
+struct BenchOutput {
+    ESP8266WebServer* server;
+    bool json;
+    bool first;
+};
+
+static void sendBenchResult(const BenchResult& result, void* context) {
+    BenchOutput* out = static_cast<BenchOutput*>(context);
+    char line[200];
+    size_t len;
+    if (out->json) {
+        line[0] = out->first ? '[' : ',';
+        len = 1 + Bench::formatJson(result, line + 1, sizeof(line) - 1);
+    } else {
+        len = Bench::formatRow(result, line, sizeof(line));
+    }
+    out->first = false;
+    out->server->sendContent(line, len);
+}
+
+// 在设备上运行热点微基准（ESP.getCycleCount() 计时），结果单位为 ns/次。
+// ?format=json 输出 JSON 数组，默认为表格；?only=codec|history|sensor|oled 只运行一组。
+// 运行期间主循环被占用约1秒，采样会推迟，传感器用例会临时切换总线时钟
+void WebServer::handleBench() {
+    String only = server.arg("only");
+    BenchOutput out = {&server, server.arg("format") == "json", true};
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, out.json ? "application/json" : "text/plain", "");
+    if (!out.json) {
+        char header[120];
+        size_t len = Bench::formatHeader(header, sizeof(header));
+        server.sendContent(header, len);
+    }
+
+    Bench bench(Bench::cycleClock, Bench::cycleNs());
+    if (only.length() == 0 || only == "codec") runCodecBenchmarks(bench, sendBenchResult, &out);
+    if (only.length() == 0 || only == "history") runHistoryBenchmarks(bench, powerMonitor, sendBenchResult, &out);
+    if (only.length() == 0 || only == "sensor") runSensorBenchmarks(bench, i2cPort, sendBenchResult, &out);
+    if (only.length() == 0 || only == "oled") {
+        sendBenchResult(bench.run("oled.render", [this]() { display.render(); }, 10), &out);
+        // 整帧发送，为传感器让出总线时只发送一部分
+        sendBenchResult(bench.run("oled.flush.full", [this]() {
+            display.invalidate();
+            display.flush();
+        }, 2), &out);
+    }
+
+    if (out.json) server.sendContent(out.first ? "[]" : "]");
+    server.sendContent("");
+}
+
+// 将序号大于 seq 的样本追加到 buffer，缓冲将满时先发送已有内容。
+// 返回 buffer 中尚未发送的长度
+int WebServer::sendSamplesSince(uint32_t seq, char* buffer, size_t size, int len) {
+    PowerSample samples[8];
+    bool first = true;
+    size_t count;
+    while ((count = powerMonitor.getSamplesSince(seq, samples, 8)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            const PowerSample& s = samples[i];
+            if (len > (int)size - 64) {
+                server.sendContent(buffer, len);
+                len = 0;
+            }
+            len += snprintf(buffer + len, size - len, "%s[%lu,%lu,%.3f,%.1f,%.0f]",
+                            first ? "" : ",", (unsigned long)s.seq, (unsigned long)s.ms,
+                            s.voltage, s.current, s.power);
+            first = false;
         }
+        seq = samples[count - 1].seq;
     }
-    
-    String response;
-    serializeJson(doc, response);
-    server.send(200, "application/json", response);
+    return len;
+}
+
+// MessagePack 版本的 /power/since：
+// {"seq","oldest","now","seq0","ms0","samples":[[ms-ms0,mv,ma10,mw],...]}
+void WebServer::sendSamplesSinceMsgPack(uint32_t seq) {
+    size_t count = powerMonitor.getCountSince(seq);
+    PowerSample samples[8];
+    size_t n = powerMonitor.getSamplesSince(seq, samples, 8);
+    uint32_t seq0 = n > 0 ? samples[0].seq : 0;
+    uint32_t ms0 = n > 0 ? samples[0].ms : 0;
+
+    uint8_t buffer[256];
+    MsgPackWriter writer(buffer, sizeof(buffer));
+    writer.writeMap(6);
+    writer.writeString("seq");
+    writer.writeUInt(powerMonitor.getLatestSeq());
+    writer.writeString("oldest");
+    writer.writeUInt(powerMonitor.getOldestSeq());
+    writer.writeString("now");
+    writer.writeUInt(millis());
+    writer.writeString("seq0");
+    writer.writeUInt(seq0);
+    writer.writeString("ms0");
+    writer.writeUInt(ms0);
+    writer.writeString("samples");
+    writer.writeArray(count);
+
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/msgpack", "");
+
+    size_t sent = 0;
+    while (n > 0 && sent < count) {
+        for (size_t i = 0; i < n && sent < count; i++, sent++) {
+            // 单个样本编码后不超过24字节
+            if (writer.length() > sizeof(buffer) - 24) {
+                server.sendContent((const char*)buffer, writer.length());
+                writer.reset();
+            }
+            writeSampleMsgPack(writer, samples[i], ms0);
+        }
+        n = powerMonitor.getSamplesSince(samples[n - 1].seq, samples, 8);
+    }
+    server.sendContent((const char*)buffer, writer.length());
+    server.sendContent("");
+}
+
+// 仪表盘所需的全部状态合并为一个响应：最新功率、电压档位、稳定状态、
+// WiFi、运行时间和剩余内存，避免多次轮询以及两次请求之间数据不一致。
+// 带 since 参数时附带此后的全部样本，图表无需再单独请求 /power/since
+void WebServer::handleSnapshot() {
+    PowerSample latest;
+    if (!powerMonitor.getLatest(latest)) {
+        memset(&latest, 0, sizeof(latest));
+    }
+    bool connected = WiFi.status() == WL_CONNECTED;
+
+    char buffer[512];
+    int len = snprintf(buffer, sizeof(buffer),
+                       "{\"seq\":%lu,\"now\":%lu,\"uptime\":%lu,\"heap\":%lu,"
+                       "\"power\":{\"voltage\":%.3f,\"current\":%.1f,\"power\":%.0f},"
+                       "\"voltage\":%d,\"settling\":%s,"
+                       "\"wifi\":{\"connected\":%s,\"ap\":%s,\"rssi\":%d}",
+                       (unsigned long)latest.seq, (unsigned long)millis(),
+                       (unsigned long)(millis() / 1000), (unsigned long)ESP.getFreeHeap(),
+                       latest.voltage, latest.current, latest.power,
+                       voltageCtl.getTargetVolts(), voltageCtl.isSettling() ? "true" : "false",
+                       connected ? "true" : "false", wifi.isAPMode() ? "true" : "false",
+                       connected ? (int)WiFi.RSSI() : 0);
+
+    if (!server.hasArg("since")) {
+        len += snprintf(buffer + len, sizeof(buffer) - len, "}");
+        server.send(200, "application/json", buffer, len);
+        return;
+    }
+
+    uint32_t seq = strtoul(server.arg("since").c_str(), nullptr, 10);
+    len += snprintf(buffer + len, sizeof(buffer) - len, ",\"samples\":[");
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/json", "");
+
+    len = sendSamplesSince(seq, buffer, sizeof(buffer), len);
+    len += snprintf(buffer + len, sizeof(buffer) - len, "]}");
+    server.sendContent(buffer, len);
+    server.sendContent("");
 }
 
 void WebServer::handleRoot() {
-    Serial.println("Handling root request");
+    LOG_DEBUG("Handling root request");
     
     // 检查 INDEX_HTML 是否有效
     if (strlen(INDEX_HTML) == 0) {
-        Serial.println("ERROR: INDEX_HTML is empty!");
+        LOG_ERROR("INDEX_HTML is empty!");
         server.send(500, "text/plain", "Internal Server Error");
         return;
     }
     
     // 发送 HTML 内容
     server.send(200, "text/html", INDEX_HTML);  // 直接使用 INDEX_HTML，不使用 FPSTR
-    Serial.println("HTML content sent successfully");
+    LOG_DEBUG("HTML content sent successfully");
 }
 
 void WebServer::handleStatus() {
-    StaticJsonDocument<512> doc;
+    StaticJsonDocument<1024> doc;
     
     // WiFi status
     doc["wifi"]["connected"] = WiFi.status() == WL_CONNECTED;
@@ -1040,6 +1444,38 @@ void WebServer::handleStatus() {
     doc["wifi"]["rssi"] = WiFi.RSSI();
     doc["wifi"]["ip"] = WiFi.localIP().toString();
     
+    // MQTT status
+    JsonObject mqtt = doc.createNestedObject("mqtt");
+    mqtt["state"] = mqttConnection.getStateName();
+    mqtt["attempts"] = mqttConnection.getAttempts();
+    mqtt["failures"] = mqttConnection.getFailures();
+    mqtt["disconnects"] = mqttConnection.getDisconnects();
+    mqtt["last_error"] = mqttConnection.getLastError();
+    mqtt["last_attempt_ms"] = mqttConnection.getLastAttemptMillis();
+    mqtt["connecting_ms"] = mqttConnection.getConnectingMillis();
+    mqtt["retry_in_ms"] = mqttConnection.getRetryInMillis();
+
+    // Main loop timing, details in /metrics
+    const LatencyStats& loop = scheduler.getLoopLatency();
+    doc["loop"]["mean_us"] = loop.getMean();
+    doc["loop"]["p99_us"] = loop.getP99();
+    doc["loop"]["max_us"] = loop.getMax();
+    doc["loop"]["overruns"] = scheduler.getOverruns();
+
+    // Log status
+    doc["log"]["written"] = Log::getWritten();
+    doc["log"]["dropped"] = Log::getDropped();
+    doc["log"]["seq"] = Log::getLatestSeq();
+    doc["log"]["buffer_used"] = Log::getUsed();
+
+    // Telemetry status
+    JsonObject tele = doc.createNestedObject("telemetry");
+    tele["published_seq"] = telemetry.getPublishedSeq();
+    tele["messages"] = telemetry.getMessageCount();
+    tele["queued"] = telemetry.getQueue().size();
+    tele["spilled"] = telemetry.getQueue().spillCount();
+    tele["dropped"] = telemetry.getQueue().getDropped();
+    tele["replayed"] = telemetry.getReplayedCount();
 
     // Build date
     doc["build_date"] = __DATE__ " " __TIME__;
@@ -1059,7 +1495,7 @@ void WebServer::handleRestart() {
 
 void WebServer::HandleConfigRoot()
 {
-    String html = R"(
+    static const char page[] PROGMEM = R"(
 <!DOCTYPE html>
 <html>
 <head>
@@ -1071,7 +1507,7 @@ void WebServer::HandleConfigRoot()
         h1 { text-align: center; color: #333; }
         .form-group { margin-bottom: 15px; }
         label { display: block; margin-bottom: 5px; color: #666; }
-        input[type="text"], input[type="password"] { width: 100%; padding: 8px; border: 1px solid #ddd; border-radius: 4px; box-sizing: border-box; }
+        input[type="text"], input[type="password"], select { width: 100%; padding: 8px; border: 1px solid #ddd; border-radius: 4px; box-sizing: border-box; }
         button { width: 100%; padding: 10px; background: #4CAF50; color: white; border: none; border-radius: 4px; cursor: pointer; }
         button:hover { background: #45a049; }
         .status { margin-top: 20px; padding: 10px; border-radius: 4px; }
@@ -1102,6 +1538,43 @@ void WebServer::HandleConfigRoot()
                 <input type="text" id="topic" name="topic" placeholder="/espRouterPower/power" required>
                 <div class="help-text">MQTT topic for power data publishing</div>
             </div>
+            <div class="form-group">
+                <label for="batch_size">Samples per Message:</label>
+                <input type="text" id="batch_size" name="batch_size" placeholder="20">
+                <div class="help-text">Samples packed into one MQTT message (1-32)</div>
+            </div>
+            <div class="form-group">
+                <label for="batch_latency">Max Publish Latency (ms):</label>
+                <input type="text" id="batch_latency" name="batch_latency" placeholder="5000">
+                <div class="help-text">A partial batch is published once its oldest sample is this old</div>
+            </div>
+            <div class="form-group">
+                <label for="encoding">Telemetry Encoding:</label>
+                <select id="encoding" name="encoding">
+                    <option value="json">JSON</option>
+                    <option value="msgpack">MessagePack (published to &lt;topic&gt;/msgpack)</option>
+                </select>
+            </div>
+            <div class="form-group">
+                <label for="heartbeat">Report-by-Exception Heartbeat (ms):</label>
+                <input type="text" id="heartbeat" name="heartbeat" placeholder="0">
+                <div class="help-text">Only publish samples that move beyond the deadband, plus one per heartbeat. 0 publishes every sample</div>
+            </div>
+            <div class="form-group">
+                <label for="queue_spill">Offline Queue:</label>
+                <select id="queue_spill" name="queue_spill">
+                    <option value="0">RAM only (64 samples)</option>
+                    <option value="1">RAM + flash (about 1300 samples)</option>
+                </select>
+                <div class="help-text">Samples taken while MQTT is down are replayed to &lt;topic&gt;/replay after reconnecting</div>
+            </div>
+            <div class="form-group">
+                <label for="log_mqtt">Publish Logs:</label>
+                <select id="log_mqtt" name="log_mqtt">
+                    <option value="0">Off</option>
+                    <option value="1">On (published to &lt;topic&gt;/log)</option>
+                </select>
+            </div>
             <button type="submit">Save Configuration</button>
         </form>
     </div>
@@ -1115,6 +1588,12 @@ void WebServer::HandleConfigRoot()
                     document.getElementById('passwd').value = config.passwd || '';
                     document.getElementById('server').value = config.server || '';
                     document.getElementById('topic').value = config.topic || '';
+                    document.getElementById('batch_size').value = config.batch_size || '';
+                    document.getElementById('batch_latency').value = config.batch_latency || '';
+                    document.getElementById('encoding').value = config.encoding || 'json';
+                    document.getElementById('heartbeat').value = config.heartbeat || '';
+                    document.getElementById('queue_spill').value = config.queue_spill ? '1' : '0';
+                    document.getElementById('log_mqtt').value = config.log_mqtt ? '1' : '0';
                 })
                 .catch(error => console.error('Error loading config:', error));
         };
@@ -1122,7 +1601,7 @@ void WebServer::HandleConfigRoot()
 </body>
 </html>
 )";
-    server.send(200, "text/html", html);
+    server.send_P(200, "text/html", page);
 }
 
 void WebServer::HandleConfigSave()
@@ -1132,14 +1611,33 @@ void WebServer::HandleConfigSave()
         server.send(400, "text/plain", "Missing parameters");
         return;
     }
-    Config config;
+    // 以当前配置为基础，保留页面上没有的字段（如死区）
+    Config config = wifi.getConfig();
     config.SSID = server.arg("ssid");
     config.Passwd = server.arg("passwd");
     config.Server = server.arg("server");
     config.Topic = server.arg("topic");
+    if (server.arg("batch_size").length() > 0) {
+        config.BatchSize = server.arg("batch_size").toInt();
+    }
+    if (server.arg("batch_latency").length() > 0) {
+        config.BatchLatency = server.arg("batch_latency").toInt();
+    }
+    if (server.hasArg("encoding")) {
+        config.Encoding = server.arg("encoding");
+    }
+    if (server.arg("heartbeat").length() > 0) {
+        config.Heartbeat = server.arg("heartbeat").toInt();
+    }
+    if (server.hasArg("queue_spill")) {
+        config.QueueSpill = server.arg("queue_spill") == "1";
+    }
+    if (server.hasArg("log_mqtt")) {
+        config.LogMqtt = server.arg("log_mqtt") == "1";
+    }
     
     if (wifi.SaveConfig(config)) {
-        String html = R"(
+        static const char page[] PROGMEM = R"(
 <!DOCTYPE html>
 <html>
 <head>
@@ -1172,7 +1670,7 @@ void WebServer::HandleConfigSave()
 </body>
 </html>
 )";
-        server.send(200, "text/html", html);
+        server.send_P(200, "text/html", page);
         
         // 延迟重启，让页面有时间显示
         delay(1000);
@@ -1184,7 +1682,7 @@ void WebServer::HandleConfigSave()
 
 
 void WebServer::handleUpgrade() {
-    String html = R"(
+    static const char page[] PROGMEM = R"(
         <!DOCTYPE html>
         <html>
         <head>
@@ -1281,7 +1779,7 @@ void WebServer::handleUpgrade() {
         </body>
         </html>
     )";
-    server.send(200, "text/html", html);
+    server.send_P(200, "text/html", page);
 }
 
 void WebServer::handleUpdate() {
@@ -1318,8 +1816,7 @@ void WebServer::handleUpdateUpload() {
 }
 
 void WebServer::handleNotFound() {
-    Serial.print("404 Not Found: ");
-    Serial.println(server.uri());
+    LOG_INFO("404 Not Found: %s", server.uri().c_str());
     server.send(404, "text/plain", "Not found");
 }
 
@@ -1347,6 +1844,12 @@ void WebServer::handleGetConfigData() {
     doc["passwd"] = config.Passwd;
     doc["server"] = config.Server;
     doc["topic"] = config.Topic;
+    doc["batch_size"] = config.BatchSize;
+    doc["batch_latency"] = config.BatchLatency;
+    doc["encoding"] = config.Encoding;
+    doc["heartbeat"] = config.Heartbeat;
+    doc["queue_spill"] = config.QueueSpill;
+    doc["log_mqtt"] = config.LogMqtt;
     
     String response;
     serializeJson(doc, response);
@@ -1358,8 +1861,7 @@ void WebServer::handleVoltage() {
     
     if (server.hasArg("level")) {
         int voltage = server.arg("level").toInt();
-        Serial.print("WebServer received voltage request: ");
-        Serial.println(voltage);
+        LOG_DEBUG("WebServer received voltage request: %d", voltage);
         
         // 将电压值转换为对应的电压等级
         uint8_t level;
@@ -1370,7 +1872,7 @@ void WebServer::handleVoltage() {
             case 15: level = VOLTAGE_15V; break;
             case 20: level = VOLTAGE_20V; break;
             default:
-                Serial.println("Invalid voltage value");
+                LOG_WARN("Invalid voltage value %d", voltage);
                 doc["success"] = false;
                 doc["error"] = "Invalid voltage value";
                 String response;
@@ -1380,11 +1882,11 @@ void WebServer::handleVoltage() {
         }
         
         if (voltageCtl.setVoltage(level)) {
-            Serial.println("Voltage set successfully");
+            LOG_DEBUG("Voltage set successfully");
             doc["success"] = true;
             doc["voltage"] = voltage;
         } else {
-            Serial.println("Failed to set voltage");
+            LOG_ERROR("Failed to set voltage");
             doc["success"] = false;
             doc["error"] = "Failed to set voltage";
         }
@@ -1400,8 +1902,7 @@ void WebServer::handleVoltage() {
             case VOLTAGE_20V: currentVoltage = 20; break;
             default: currentVoltage = 0;
         }
-        Serial.print("Current voltage level: ");
-        Serial.println(currentVoltage);
+        LOG_DEBUG("Current voltage level: %d", currentVoltage);
         doc["voltage"] = currentVoltage;
     }
     
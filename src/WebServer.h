@@ -7,14 +7,31 @@
 #include "PowerMonitor.h"
 #include "Display.h"
 #include "VoltageCtl.h"
+#include "MqttConnection.h"
+#include "Telemetry.h"
+#include "Scheduler.h"
+#include "I2cBus.h"
+#include "SensorTrace.h"
+#include "HeapMonitor.h"
 
 #define BUTTON_PIN 0  
 
 
 
+// 网页只读取状态或转发操作的子系统，由 main.cpp 组装后传入
+struct WebServerContext {
+    MqttConnection& mqttConnection;
+    PowerTelemetry& telemetry;
+    Scheduler& scheduler;
+    I2cBus& i2cBus;
+    I2cPort& i2cPort;
+    TraceRecorder& traceRecorder;
+};
+
 class WebServer {
 public:
-    WebServer(EspSmartWifi& wifi, EasyLed& led, Display& display, VoltageCtl &voltagectl);
+    WebServer(EspSmartWifi& wifi, EasyLed& led, Display& display, VoltageCtl &voltagectl, PowerMonitor &powermonitor,
+              const WebServerContext& context);
     void begin();
     void handleClient();
     void stop();
@@ -28,8 +45,14 @@ private:
     EspSmartWifi& wifi;
     EasyLed& led;
     Display& display;
-    PowerMonitor powerMonitor;
     VoltageCtl &voltageCtl;
+    PowerMonitor &powerMonitor;
+    MqttConnection& mqttConnection;
+    PowerTelemetry& telemetry;
+    Scheduler& scheduler;
+    I2cBus& i2cBus;
+    I2cPort& i2cPort;
+    TraceRecorder& traceRecorder;
     
     
     
@@ -37,13 +60,24 @@ private:
     void handleRoot();
     void handleStatus();
     void handlePower();
+    void handlePowerSince();
+    void handleSnapshot();
+    void handleLogs();
+    void handleMetrics();
+    void handleMetricsBudget();
+    void handleTrace();
+    void handleTraceStart();
+    void handleTraceData();
+    void handleBench();
+    int sendSamplesSince(uint32_t seq, char* buffer, size_t size, int len);
+    void sendSamplesSinceMsgPack(uint32_t seq);
+    bool wantsMsgPack();
     void handleVoltage();
     void handleRestart();
     void handleUpgrade();
     void handleUpdate();
     void handleUpdateUpload();
     void handleNotFound();
-    bool initPowerMonitor();
     
     // config pages
     void HandleConfigRoot();
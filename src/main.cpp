@@ -12,6 +12,17 @@
 #include "WebServer.h"
 #include "PowerMonitor.h"
 #include "Display.h"
+#include "Telemetry.h"
+#include "MqttConnection.h"
+#include "CommandChannel.h"
+#include "Log.h"
+#include "LogPublisher.h"
+#include "Scheduler.h"
+#include "Button.h"
+#include "LedPattern.h"
+#include "I2cBus.h"
+#include "SensorTrace.h"
+#include "HeapMonitor.h"
 
 //#define PIN        D8
 
@@ -25,11 +36,39 @@ Adafruit_NeoPixel pixels(NUM_LEDS, RGB_LED_PIN, NEO_GRB + NEO_KHZ800);
 // Global variables
 EasyLed led(STATUS_LED, EasyLed::ActiveLevel::Low, EasyLed::State::Off);
 EspSmartWifi wifi(led);
-Display display;
+I2cBus i2cBus;
+WirePort i2cPort(i2cBus);
+I2cEngine i2cEngine(i2cPort);
 VoltageCtl voltageCtl;
-WebServer webServer(wifi, led, display, voltageCtl);
 PowerMonitor powerMonitor;
+Display display(wifi, powerMonitor);
 PubSubClient mqtt(wifi.client);
+MqttConnection mqttConnection(mqtt, wifi.client);
+PowerTelemetry telemetry(powerMonitor, mqtt);
+CommandChannel commands(mqtt, powerMonitor, voltageCtl);
+LogPublisher logPublisher(mqtt);
+Scheduler scheduler;
+TraceRecorder traceRecorder;
+WebServer webServer(wifi, led, display, voltageCtl, powerMonitor,
+                    WebServerContext{mqttConnection, telemetry, scheduler, i2cBus, i2cPort, traceRecorder});
+
+// STATUS_LED 与 NeoPixel 的图案播放器，由 led 任务推进
+PatternPlayer statusLed([](uint32_t color) {
+    if (color) led.on(); else led.off();
+});
+PatternPlayer pixelLed([](uint32_t color) {
+    pixels.setPixelColor(0, color);
+    pixels.show();
+});
+uint8_t pixelBrightness = BRIGHTNESS;
+
+// 常用提示图案：颜色、亮(ms)、灭(ms)、次数（0为持续）
+const LedPattern PATTERN_VOLTAGE_STEP = {1, 100, 100, 1};
+const LedPattern PATTERN_CONFIG_CLEARED = {1, 100, 100, 5};
+const LedPattern PATTERN_VOLTAGE_FAULT = {1, 50, 50, 0};
+const LedPattern PATTERN_MQTT_RETRY = {1, 50, 50, 2};
+const LedPattern PATTERN_PUBLISH = {1, 25, 25, 1};
+const LedPattern PATTERN_AP_MODE = {1, 10, 1990, 0};
 
 // How many NeoPixels are attached to the Arduino?
 //#define NUMPIXELS 1 // Popular NeoPixel ring size
@@ -40,188 +79,155 @@ PubSubClient mqtt(wifi.client);
 // strandtest example for more information on possible values.
 //Adafruit_NeoPixel pixels(NUMPIXELS, PIN, NEO_GRB + NEO_KHZ800);
 
-// 添加按钮状态变量
-bool lastButtonState = HIGH;
-unsigned long lastButtonPress = 0;
-const unsigned long debounceDelay = 50;
+// 按键：单击升一档电压，双击降一档，长按3秒清除配置并重启
+Button button(BUTTON_PIN);
+unsigned long restartAt = 0;  // 非0时到达该 millis() 后重启
 
 // 添加电压切换相关的变量
 uint8_t voltageLevels[] = {VOLTAGE_5V, VOLTAGE_9V, VOLTAGE_12V, VOLTAGE_15V, VOLTAGE_20V};  // 电压等级
-int currentVoltageIndex = 0;  // 当前电压等级索引
-
-// 解析MQTT服务器地址
-bool parseMQTTServer(const String& serverUrl, String& host, int& port, String& username, String& password) {
-    // 检查URL格式
-    if (!serverUrl.startsWith("mqtt://")) {
-        Serial.println("Invalid MQTT server URL format");
-        return false;
-    }
+const int voltageLevelCount = sizeof(voltageLevels) / sizeof(voltageLevels[0]);
 
-    // 移除 mqtt:// 前缀
-    String url = serverUrl.substring(7);
-    
-    // 检查是否有认证信息
-    int atPos = url.indexOf('@');
-    if (atPos != -1) {
-        // 有认证信息
-        String auth = url.substring(0, atPos);
-        int colonPos = auth.indexOf(':');
-        if (colonPos != -1) {
-            username = auth.substring(0, colonPos);
-            password = auth.substring(colonPos + 1);
-        }
-        url = url.substring(atPos + 1);
+// 从当前电压档位移动 step 档（循环）
+void stepVoltage(int step) {
+    int index = 0;
+    for (int i = 0; i < voltageLevelCount; i++) {
+        if (voltageLevels[i] == voltageCtl.getCurrentVoltage()) index = i;
     }
+    index = (index + step + voltageLevelCount) % voltageLevelCount;
+    uint8_t newVoltageLevel = voltageLevels[index];
+
+    // 设置新的电压
+    if (voltageCtl.setVoltage(newVoltageLevel)) {
+        // 显示当前电压等级
+        LOG_INFO("Switching to voltage level: %d", newVoltageLevel);
 
-    // 检查是否有端口号
-    int colonPos = url.indexOf(':');
-    if (colonPos != -1) {
-        host = url.substring(0, colonPos);
-        port = url.substring(colonPos + 1).toInt();
+        // 闪烁LED指示电压切换
+        statusLed.play(PATTERN_ACTIVITY, PATTERN_VOLTAGE_STEP);
     } else {
-        host = url;
-        port = 1883; // 默认端口
+        LOG_ERROR("Failed to set voltage level");
     }
-
-    return true;
 }
 
-// 连接MQTT服务器
-bool connectMQTT() {
-    const Config& config = wifi.getConfig();
-    String host;
-    int port;
-    String username;
-    String password;
-    
-    if (parseMQTTServer(config.Server, host, port, username, password)) {
-        mqtt.setServer(host.c_str(), port);
-        mqtt.setBufferSize(2048);
-        
-        // 使用lambda函数作为回调
-        mqtt.setCallback([](char* topic, byte* payload, unsigned int length) {
-            const Config& config = wifi.getConfig();
-            if (strcmp(topic, config.Topic.c_str()) == 0) {
-                String message;
-                for (int i = 0; i < length; i++) {
-                    message += (char)payload[i];
+// 处理按键手势，由调度器周期调用，不会阻塞等待按键松开
+void buttonTask() {
+    if (restartAt != 0 && (long)(millis() - restartAt) >= 0) {
+        Log::flush();
+        ESP.restart();
+    }
+
+    button.update();
+    ButtonEvent event;
+    while (button.getEvent(event)) {
+        switch (event) {
+            case BUTTON_SHORT:
+                stepVoltage(1);
+                break;
+            case BUTTON_DOUBLE:
+                stepVoltage(-1);
+                break;
+            case BUTTON_LONG:
+                // 清除配置文件，1秒后重启，期间主循环照常运行
+                if (SPIFFS.remove("/config.json")) {
+                    LOG_WARN("Configuration cleared, restarting...");
+                    statusLed.play(PATTERN_NOTICE, PATTERN_CONFIG_CLEARED);  // 快速闪烁5次表示清除成功
+                    restartAt = millis() + 1000;
                 }
-                Serial.print(message.c_str());
-            }
-        });
-        
-        // 生成客户端ID
-        String clientId = "EspRouterPower" + String(ESP.getChipId(), HEX);
-        
-        // 如果有认证信息，设置用户名和密码
-        if (username.length() > 0) {
-            return mqtt.connect(clientId.c_str(), username.c_str(), password.c_str());
-        } else {
-            return mqtt.connect(clientId.c_str());
+                break;
+            default:
+                break;
         }
     }
-    return false;
 }
 
-// 发送MQTT消息的辅助函数
-void publishMQTT(const char* topic, const char* message) {
-    if (WiFi.status() == WL_CONNECTED && mqtt.connected()) {
-        mqtt.publish(topic, message);
-        mqtt.loop();  // 确保消息被处理
+// 电压指示与保护：RGB颜色表示实际电压档位，电压异常时STATUS_LED快速闪烁、RGB闪烁。
+// 这里只选择图案，实际输出由 led 任务完成
+void indicatorTask() {
+    PowerSample sample;
+    if (!powerMonitor.getLatest(sample)) return;
+    float current = sample.current;
+    float voltage = sample.voltage;
+
+    // 根据实际电压区间设置RGB颜色
+    uint32_t color = pixels.Color(128, 128, 0); // 默认
+    if (voltage >= 4.6 && voltage <= 5.4) {
+        color = pixels.Color(0, 255, 0); // 绿色
+    } else if (voltage >= 8.6 && voltage <= 9.4) {
+        color = pixels.Color(0, 0, 255); // 蓝色
+    } else if (voltage >= 11.6 && voltage <= 12.4) {
+        color = pixels.Color(128, 0, 128); // 紫色
+    } else if (voltage >= 14.6 && voltage <= 15.4) {
+        color = pixels.Color(255, 0, 0); // 红色
+    } else if (voltage >= 19.6 && voltage <= 20.4) {
+        color = pixels.Color(255, 255, 255); // 白色
+    }
+
+    // 亮度随电流变化
+    uint8_t brightness = map(constrain(current, 0, 1000), 0, 1000, 10, 255);
+    if (brightness != pixelBrightness) {
+        pixelBrightness = brightness;
+        pixels.setBrightness(brightness);
+        pixelLed.invalidate();
+    }
+    LedPattern solid = {color, 1, 0, 0};
+    pixelLed.play(PATTERN_IDLE, solid);
+
+    // 电压异常时持续告警直到恢复（切换后的稳定期内不判断）
+    float setTarget = voltageCtl.getTargetVolts();
+    if (!voltageCtl.isSettling() && fabs(voltage - setTarget) > 0.4) {
+        statusLed.play(PATTERN_FAULT, PATTERN_VOLTAGE_FAULT);
+    } else {
+        statusLed.stop(PATTERN_FAULT);
     }
 }
 
-// 发送电源监控数据的函数
-void publishPowerData() {
-    StaticJsonDocument<512> doc;
-    
-    Serial.println("\n=== Power Monitor Readings ===");
-    // 获取三个通道的数据
-    for (int i = 0; i < 1; i++) {
-        float current = powerMonitor.getCurrent_mA();
-        float voltage = powerMonitor.getBusVoltage_V();
-        float power = powerMonitor.getPower_mW();
-        
-        // 打印到串口
-        Serial.print("Channel ");
-        Serial.print(i + 1);
-        Serial.println(":");
-        Serial.print("  Current: ");
-        Serial.print(current, 3);
-        Serial.println(" mA");
-        Serial.print("  Voltage: ");
-        Serial.print(voltage, 3);
-        Serial.println(" V");
-        Serial.print("  Power: ");
-        Serial.print(power, 3);
-        Serial.println(" mW");
-        
-        // 添加到JSON文档
-        JsonObject channel = doc.createNestedObject("channel" + String(i + 1));
-        channel["current"] = current;
-        channel["voltage"] = voltage;
-        channel["power"] = power;
-        
+// 维护MQTT连接：已连接时处理消息，断开时按退避计划重连
+void mqttTask() {
+    if (mqttConnection.loop()) {
+        statusLed.play(PATTERN_ACTIVITY, PATTERN_MQTT_RETRY);
     }
-    Serial.println("===========================\n");
-    
-    char buffer[512];
-    serializeJson(doc, buffer);
-    const Config& config = wifi.getConfig();
-    publishMQTT(config.Topic.c_str(), buffer);
 }
 
-// 处理按钮输入的函数
-void checkButton() {
-    bool currentButtonState = digitalRead(BUTTON_PIN);
-    
-    // 检测按钮按下（防抖）
-    if (currentButtonState != lastButtonState) {
-        if (millis() - lastButtonPress > debounceDelay) {
-            if (currentButtonState == LOW) {  // 按钮按下
-                // 记录按下时间
-                unsigned long pressStartTime = millis();
-                
-                // 等待按钮释放
-                while (digitalRead(BUTTON_PIN) == LOW) {
-                    delay(50);  // 每50ms检查一次
-                    
-                    // 如果长按超过3秒
-                    if (millis() - pressStartTime > 3000) {
-                        // 清除配置文件
-                        if (SPIFFS.remove("/config.json")) {
-                            Serial.println("Configuration cleared, restarting...");
-                            led.flash(5, 100, 100, 0, 0);  // 快速闪烁5次表示清除成功
-                            delay(1000);
-                            ESP.restart();
-                        }
-                        break;
-                    }
-                }
-                
-                // 如果按下时间小于3秒，执行短按操作
-                if (millis() - pressStartTime < 3000) {
-                    // 切换到下一个电压等级
-                    currentVoltageIndex = (currentVoltageIndex + 1) % (sizeof(voltageLevels) / sizeof(voltageLevels[0]));
-                    uint8_t newVoltageLevel = voltageLevels[currentVoltageIndex];
-                    
-                    // 设置新的电压
-                    if (voltageCtl.setVoltage(newVoltageLevel)) {
-                        // 显示当前电压等级
-                        Serial.print("Switching to voltage level: ");
-                        Serial.println(newVoltageLevel);
-                        
-                        // 闪烁LED指示电压切换
-                        led.flash(1, 100, 100, 0, 0);
-                    } else {
-                        Serial.println("Failed to set voltage level");
-                    }
-                }
-            }
-            lastButtonPress = millis();
-        }
+// 批量发布采样缓冲中的数据，不直接读取传感器；离线时样本进入离线队列
+void telemetryTask() {
+    if (telemetry.loop()) {
+        statusLed.play(PATTERN_ACTIVITY, PATTERN_PUBLISH);
+    }
+}
+
+// 推进两个图案播放器，只在亮灭变化时写输出
+void ledTask() {
+    // AP模式下空闲时慢闪提示
+    if (wifi.isAPMode()) {
+        statusLed.play(PATTERN_IDLE, PATTERN_AP_MODE);
+    } else {
+        statusLed.stop(PATTERN_IDLE);
     }
-    lastButtonState = currentButtonState;
+    statusLed.update();
+    pixelLed.update();
+}
+
+// 输出缓冲中的日志，只写串口发送缓冲能容纳的部分
+void logTask() {
+    Log::drain();
+    logPublisher.loop();
+}
+
+// 注册主循环任务：周期(ms)、优先级、单次时间预算(μs)。
+// 采样和电压保护优先级最高，不会被网页或显示拖慢
+void setupTasks() {
+    scheduler.addTask("sensor", []() { powerMonitor.update(); }, POWER_SAMPLE_INTERVAL_MS, PRIORITY_CRITICAL, 1000);
+    scheduler.addTask("i2c", []() { i2cEngine.poll(); }, 1, PRIORITY_CRITICAL, 500);
+    scheduler.addTask("button", buttonTask, 10, PRIORITY_HIGH, 1000);
+    scheduler.addTask("indicator", indicatorTask, 200, PRIORITY_HIGH, 2000);
+    scheduler.addTask("led", ledTask, 10, PRIORITY_HIGH, 500);
+    scheduler.addTask("mqtt", mqttTask, 10, PRIORITY_NORMAL, 10000);
+    scheduler.addTask("telemetry", telemetryTask, 50, PRIORITY_NORMAL, 10000);
+    scheduler.addTask("wifi", []() { wifi.WiFiWatchDog(); }, 500, PRIORITY_NORMAL, 5000);
+    scheduler.addTask("web", []() { webServer.handleClient(); }, 2, PRIORITY_LOW, 20000);
+    scheduler.addTask("display", []() { display.update(); }, 100, PRIORITY_LOW, 30000);
+    scheduler.addTask("log", logTask, 5, PRIORITY_LOW, 1000);
+    scheduler.addTask("trace", []() { traceRecorder.loop(); }, 100, PRIORITY_LOW, 5000);
+    scheduler.addTask("heap", HeapMonitor::sample, HEAP_SAMPLE_MS, PRIORITY_LOW, 500);
 }
 
 void setup() {
@@ -233,136 +239,55 @@ void setup() {
     pixels.setBrightness(BRIGHTNESS);
     pixels.show(); // 初始化时关闭所有LED
     
+    // 初始化I2C总线，传感器和OLED共用
+    i2cBus.begin();
+    i2cBus.setEngine(&i2cEngine);
+
     // 初始化电源监控
-    if (!powerMonitor.begin()) {
+    if (!powerMonitor.begin(i2cBus, i2cEngine)) {
         Serial.println("Failed to initialize power monitor!");
     }
+    powerMonitor.setTrace(&traceRecorder);
 
     // 初始化OLED显示
-    if (!display.begin()) {
+    if (!display.begin(i2cBus)) {
         Serial.println("Failed to initialize OLED display!");
     }
+    i2cBus.restoreClock();
 
     wifi.initFS();
     wifi.ConnectWifi();
     wifi.DisplayIP();
+    // 启动完成后的LED提示不再阻塞
+    wifi.setPatternPlayer(&statusLed);
     
+    telemetry.begin(wifi.getConfig());
+
     voltageCtl.begin();
     // 启动WebServer
     webServer.begin();
     
-    // 连接MQTT服务器
-    if (!connectMQTT()) {
-        Serial.println("Failed to connect to MQTT server");
+    // 解析MQTT服务器地址，连接在loop()中按退避计划进行
+    if (!mqttConnection.begin(wifi.getConfig())) {
+        Serial.println("Invalid MQTT server, telemetry disabled");
     }
-
-    delay(500); // 等待MQTT连接
-
-    // 初始化按钮引脚
-    pinMode(BUTTON_PIN, INPUT_PULLUP);
+    // 远程命令：订阅 <topic>/cmd，应答发布到 <topic>/rsp
+    commands.begin(wifi.getConfig());
+    mqttConnection.setSubscription(commands.getCommandTopic());
+    logPublisher.begin(wifi.getConfig());
+    mqtt.setCallback([](char* topic, byte* payload, unsigned int length) {
+        HeapMonitor::Scope heap(HEAP_SITE_MQTT_RX);
+        commands.handle(topic, payload, length);
+        // 应答已经发布，记录处理期间留下的占用
+        heap.mark();
+    });
+
+    // 初始化按钮引脚，边沿由中断记录
+    button.begin();
+
+    setupTasks();
 }
 
-int loop_count = 0;
-
 void loop() {
-    // 处理按钮输入（放在最前面，确保不会被阻塞）
-    checkButton();
-
-    // 检查WiFi连接状态，内部会delay(1000)如果没连上Wi-Fi
-    wifi.WiFiWatchDog();
-    
-    // 处理WebServer请求
-    webServer.handleClient();
-
-    // 更新OLED显示
-    display.update();
-
-    if (loop_count % 100 == 0)
-    {
-        // 获取电压和电流值
-        float current = powerMonitor.getCurrent_mA();
-        float voltage = powerMonitor.getBusVoltage_V();
-        
-        // 根据实际电压区间设置RGB颜色
-        uint32_t color = pixels.Color(128, 128, 0); // 默认
-        if (voltage >= 4.6 && voltage <= 5.4) {
-            color = pixels.Color(0, 255, 0); // 绿色
-        } else if (voltage >= 8.6 && voltage <= 9.4) {
-            color = pixels.Color(0, 0, 255); // 蓝色
-        } else if (voltage >= 11.6 && voltage <= 12.4) {
-            color = pixels.Color(128, 0, 128); // 紫色
-        } else if (voltage >= 14.6 && voltage <= 15.4) {
-            color = pixels.Color(255, 0, 0); // 红色
-        } else if (voltage >= 19.6 && voltage <= 20.4) {
-            color = pixels.Color(255, 255, 255); // 白色
-        }
-
-        // 亮度随电流变化
-        uint8_t brightness = map(constrain(current, 0, 1000), 0, 1000, 10, 255);
-        pixels.setBrightness(brightness);
-        pixels.setPixelColor(0, color);
-        pixels.show();
-
-        // 电压异常时STATUS_LED快速闪烁
-        float setTarget = 0;
-        switch (voltageCtl.getCurrentVoltage()) {
-            case VOLTAGE_5V:  setTarget = 5.0; break;
-            case VOLTAGE_9V:  setTarget = 9.0; break;
-            case VOLTAGE_12V: setTarget = 12.0; break;
-            case VOLTAGE_15V: setTarget = 15.0; break;
-            case VOLTAGE_20V: setTarget = 20.0; break;
-            default: setTarget = 0; break;
-        }
-        if (fabs(voltage - setTarget) > 0.4) {
-            led.flash(10, 50, 50, 0, 0); // 快速闪烁10次
-        } else {
-            led.off();
-        }
-    }
-    
-    // 如果WiFi和MQTT都连接成功
-    if (WiFi.status() == WL_CONNECTED && mqtt.connected()) 
-    {
-        // 定期处理MQTT消息
-        mqtt.loop();
-        loop_count++;
-        if (loop_count % 10000 == 0) 
-        {
-            // 每秒发布一次电源数据
-            publishPowerData();
-            led.flash(1, 25, 25, 0, 0);
-        }
-    } 
-    else 
-    {
-        // 如果WiFi或MQTT连接断开，尝试重新连接
-        if (wifi.isAPMode())
-        {            
-            loop_count++;
-            if (loop_count % 2000 == 0) 
-            {
-                led.flash(1, 10, 50, 0, 0);
-                delay(10);
-            }
-        } 
-        else 
-        {
-            if (!mqtt.connected())
-            {
-                loop_count++;
-                if (loop_count % 5000 == 0) 
-                {
-                    if (!connectMQTT()) 
-                    {
-                        Serial.println("Failed to reconnect to MQTT server");
-                    }
-                    led.flash(2, 50, 50, 0, 0);
-                }
-            }
-        }
-
-    }
-
-
-    delay(1);  // 减少主循环延迟
-}
\ No newline at end of file
+    scheduler.loop();
+}
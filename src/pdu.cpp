@@ -0,0 +1,458 @@
+#include "pdu.h"
+
+// 十六进制字符值，非十六进制为 -1
+static const int8_t HEX_VALUES[128] PROGMEM = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+// GSM 03.38 默认字母表到 Unicode，0x1B 为扩展表转义
+static const uint16_t GSM7_BASIC[128] PROGMEM = {
+    0x0040, 0x00A3, 0x0024, 0x00A5, 0x00E8, 0x00E9, 0x00F9, 0x00EC,
+    0x00F2, 0x00C7, 0x000A, 0x00D8, 0x00F8, 0x000D, 0x00C5, 0x00E5,
+    0x0394, 0x005F, 0x03A6, 0x0393, 0x039B, 0x03A9, 0x03A0, 0x03A8,
+    0x03A3, 0x0398, 0x039E, 0x00A0, 0x00C6, 0x00E6, 0x00DF, 0x00C9,
+    0x0020, 0x0021, 0x0022, 0x0023, 0x00A4, 0x0025, 0x0026, 0x0027,
+    0x0028, 0x0029, 0x002A, 0x002B, 0x002C, 0x002D, 0x002E, 0x002F,
+    0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037,
+    0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F,
+    0x00A1, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047,
+    0x0048, 0x0049, 0x004A, 0x004B, 0x004C, 0x004D, 0x004E, 0x004F,
+    0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057,
+    0x0058, 0x0059, 0x005A, 0x00C4, 0x00D6, 0x00D1, 0x00DC, 0x00A7,
+    0x00BF, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067,
+    0x0068, 0x0069, 0x006A, 0x006B, 0x006C, 0x006D, 0x006E, 0x006F,
+    0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077,
+    0x0078, 0x0079, 0x007A, 0x00E4, 0x00F6, 0x00F1, 0x00FC, 0x00E0,
+};
+
+// 扩展表：ESC 之后的编码及对应的 Unicode
+static const uint16_t GSM7_EXTENDED[][2] PROGMEM = {
+    {0x0A, 0x000C}, {0x14, 0x005E}, {0x28, 0x007B}, {0x29, 0x007D}, {0x2F, 0x005C},
+    {0x3C, 0x005B}, {0x3D, 0x007E}, {0x3E, 0x005D}, {0x40, 0x007C}, {0x65, 0x20AC},
+};
+
+// 号码中的半字节：0-9 * # a b c
+static const char BCD_DIGITS[] = "0123456789*#abc";
+
+// 编码后放不下时返回0
+static size_t putUtf8(uint32_t cp, char* out, size_t room) {
+    if (cp < 0x80) {
+        if (room < 1) return 0;
+        out[0] = cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        if (room < 2) return 0;
+        out[0] = 0xC0 | (cp >> 6);
+        out[1] = 0x80 | (cp & 0x3F);
+        return 2;
+    }
+    if (cp < 0x10000) {
+        if (room < 3) return 0;
+        out[0] = 0xE0 | (cp >> 12);
+        out[1] = 0x80 | ((cp >> 6) & 0x3F);
+        out[2] = 0x80 | (cp & 0x3F);
+        return 3;
+    }
+    if (room < 4) return 0;
+    out[0] = 0xF0 | (cp >> 18);
+    out[1] = 0x80 | ((cp >> 12) & 0x3F);
+    out[2] = 0x80 | ((cp >> 6) & 0x3F);
+    out[3] = 0x80 | (cp & 0x3F);
+    return 4;
+}
+
+static inline int hexValue(char c) {
+    return (unsigned char)c < 128 ? (int8_t)pgm_read_byte(&HEX_VALUES[(unsigned char)c]) : -1;
+}
+
+static inline int hexByte(const char* p) {
+    return (hexValue(p[0]) << 4) | hexValue(p[1]);
+}
+
+static bool isHex(const char* s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (hexValue(s[i]) < 0) return false;
+    }
+    return len > 0;
+}
+
+static inline bool isHighSurrogate(uint32_t u) { return u >= 0xD800 && u <= 0xDBFF; }
+static inline bool isLowSurrogate(uint32_t u) { return u >= 0xDC00 && u <= 0xDFFF; }
+
+// 按 UCS2 解读是否合理：没有换行/制表符以外的控制字符，代理成对出现
+static bool looksLikeUcs2(const char* hex, size_t len) {
+    bool expectLow = false;
+    for (size_t i = 0; i + 4 <= len; i += 4) {
+        uint32_t u = ((uint32_t)hexByte(hex + i) << 8) | hexByte(hex + i + 2);
+        if (expectLow != isLowSurrogate(u)) return false;
+        expectLow = isHighSurrogate(u);
+        if (u < 0x20 && u != '\n' && u != '\r' && u != '\t') return false;
+        if (u >= 0x80 && u < 0xA0) return false;
+    }
+    return !expectLow;
+}
+
+// 8位数据按 Latin-1 转 UTF-8
+static size_t latin1ToUtf8(const uint8_t* data, size_t bytes, char* out, size_t size) {
+    size_t len = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        size_t n = putUtf8(data[i], out + len, size - len);
+        if (n == 0) break;
+        len += n;
+    }
+    return len;
+}
+
+size_t PDUHelper::hexToBytes(const char* hex, size_t len, uint8_t* out, size_t size) {
+    size_t n = 0;
+    for (size_t i = 0; i + 1 < len && n < size; i += 2) {
+        int hi = hexValue(hex[i]);
+        int lo = hexValue(hex[i + 1]);
+        if (hi < 0 || lo < 0) break;
+        out[n++] = (hi << 4) | lo;
+    }
+    return n;
+}
+
+size_t PDUHelper::ucs2ToUtf8(const uint8_t* data, size_t bytes, char* out, size_t size) {
+    size_t len = 0;
+    size_t i = 0;
+    while (i + 1 < bytes) {
+        uint32_t cp = ((uint32_t)data[i] << 8) | data[i + 1];
+        i += 2;
+        if (isHighSurrogate(cp)) {
+            uint32_t low = i + 1 < bytes ? (((uint32_t)data[i] << 8) | data[i + 1]) : 0;
+            if (isLowSurrogate(low)) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                i += 2;
+            } else {
+                cp = 0xFFFD;
+            }
+        } else if (isLowSurrogate(cp)) {
+            cp = 0xFFFD;
+        }
+        size_t n = putUtf8(cp, out + len, size - len);
+        if (n == 0) break;
+        len += n;
+    }
+    return len;
+}
+
+size_t PDUHelper::unpackSeptets(const uint8_t* packed, size_t bytes, size_t septets, size_t skip,
+                                uint8_t* out, size_t size) {
+    size_t n = 0;
+    for (size_t i = skip; i < septets && n < size; i++) {
+        size_t bit = i * 7;
+        size_t index = bit / 8;
+        size_t shift = bit % 8;
+        if (index >= bytes) break;
+        uint16_t v = packed[index] >> shift;
+        // 跨字节的字符，高位在下一个字节的低位
+        if (shift > 1 && index + 1 < bytes) v |= (uint16_t)packed[index + 1] << (8 - shift);
+        out[n++] = v & 0x7F;
+    }
+    return n;
+}
+
+size_t PDUHelper::gsm7ToUtf8(const uint8_t* septets, size_t count, char* out, size_t size) {
+    size_t len = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint8_t c = septets[i] & 0x7F;
+        uint32_t cp;
+        if (c == 0x1B && i + 1 < count) {
+            // 扩展表中没有的字符按默认表显示
+            uint8_t e = septets[++i] & 0x7F;
+            cp = pgm_read_word(&GSM7_BASIC[e]);
+            for (size_t k = 0; k < sizeof(GSM7_EXTENDED) / sizeof(GSM7_EXTENDED[0]); k++) {
+                if (pgm_read_word(&GSM7_EXTENDED[k][0]) == e) {
+                    cp = pgm_read_word(&GSM7_EXTENDED[k][1]);
+                    break;
+                }
+            }
+        } else {
+            cp = pgm_read_word(&GSM7_BASIC[c]);
+        }
+        size_t n = putUtf8(cp, out + len, size - len);
+        if (n == 0) break;
+        len += n;
+    }
+    return len;
+}
+
+String PDUHelper::decodeHexToString(const String& hex) {
+    // 只从一处返回 out，便于返回值优化
+    String out;
+    const char* s = hex.c_str();
+    size_t len = hex.length();
+    if (!isHex(s, len)) {
+        out = hex;
+        return out;
+    }
+
+    // 奇数个十六进制位时忽略最后一位
+    len &= ~(size_t)1;
+    bool ucs2 = len % 4 == 0 && looksLikeUcs2(s, len);
+
+    // 输出上界：UCS2 每码元最多3字节，Latin-1 每字节最多2字节。只分配一次
+    out.reserve(ucs2 ? len / 4 * 3 : len);
+    uint8_t bytes[64];
+    char text[sizeof(bytes) * 2];
+    size_t pos = 0;
+    while (pos < len) {
+        size_t n = hexToBytes(s + pos, len - pos, bytes, sizeof(bytes));
+        // 不在两块之间拆开代理对
+        if (ucs2 && n == sizeof(bytes) && pos + n * 2 < len && isHighSurrogate(((uint32_t)bytes[n - 2] << 8) | bytes[n - 1])) {
+            n -= 2;
+        }
+        size_t t = ucs2 ? ucs2ToUtf8(bytes, n, text, sizeof(text)) : latin1ToUtf8(bytes, n, text, sizeof(text));
+        out.concat(text, t);
+        pos += n * 2;
+    }
+    return out;
+}
+
+String PDUHelper::decodeContent(const String& content) {
+    int len = content.length();
+    while (len > 0 && (content.charAt(len - 1) == '\r' || content.charAt(len - 1) == '\n')) len--;
+    if (len == (int)content.length()) return decodeHexToString(content);
+    return decodeHexToString(content.substring(0, len));
+}
+
+bool PDUHelper::decodePdu(const String& pdu, SmsMessage& message) {
+    return decodePdu(pdu.c_str(), pdu.length(), message);
+}
+
+// 发送方地址：长度为半字节数（字母数字地址为其所占的半字节数）
+static bool decodeAddress(const uint8_t* b, size_t available, size_t& used, String& out) {
+    if (available < 2) return false;
+    uint8_t digits = b[0];
+    uint8_t toa = b[1];
+    size_t octets = (digits + 1) / 2;
+    if (available < 2 + octets || digits > 20) return false;
+    used = 2 + octets;
+
+    char text[SMS_MAX_PDU_BYTES];
+    size_t len = 0;
+    if ((toa & 0x70) == 0x50) {
+        uint8_t septets[24];
+        size_t n = PDUHelper::unpackSeptets(b + 2, octets, digits * 4 / 7, 0, septets, sizeof(septets));
+        len = PDUHelper::gsm7ToUtf8(septets, n, text, sizeof(text) - 1);
+    } else {
+        if ((toa & 0x70) == 0x10) text[len++] = '+';
+        for (size_t i = 0; i < digits; i++) {
+            uint8_t nibble = i % 2 == 0 ? b[2 + i / 2] & 0x0F : b[2 + i / 2] >> 4;
+            if (nibble == 0x0F) break;
+            text[len++] = BCD_DIGITS[nibble];
+        }
+    }
+    text[len] = 0;
+    out = text;
+    return true;
+}
+
+// 时间戳各字段为半字节交换的 BCD，时区最高位（交换后）为符号，输出 yy/MM/dd,hh:mm:ss±zz。
+// 任一半字节大于9即为无效时间戳，返回false
+static bool decodeTimestamp(const uint8_t* b, String& out) {
+    static const char SEPARATORS[] = "//,::";
+    char text[21];
+    size_t len = 0;
+    for (int i = 0; i < 7; i++) {
+        // 时区的符号位不属于数字
+        uint8_t low = i == 6 ? b[i] & 0x07 : b[i] & 0x0F;
+        uint8_t high = b[i] >> 4;
+        if (low > 9 || high > 9) return false;
+        if (i == 6) text[len++] = (b[i] & 0x08) ? '-' : '+';
+        text[len++] = '0' + low;
+        text[len++] = '0' + high;
+        if (i < 5) text[len++] = SEPARATORS[i];
+    }
+    text[len] = 0;
+    out = text;
+    return true;
+}
+
+bool PDUHelper::decodePdu(const char* hex, size_t len, SmsMessage& message) {
+    uint8_t b[SMS_MAX_PDU_BYTES];
+    size_t n = hexToBytes(hex, len, b, sizeof(b));
+    if (n < 1) return false;
+
+    // 跳过服务中心地址
+    size_t pos = 1 + b[0];
+    if (pos >= n) return false;
+    uint8_t firstOctet = b[pos++];
+    if ((firstOctet & 0x03) != 0) return false;     // 只处理 SMS-DELIVER
+
+    size_t used;
+    if (!decodeAddress(b + pos, n - pos, used, message.sender)) return false;
+    pos += used;
+
+    // PID、DCS、时间戳(7)、UDL
+    if (pos + 10 > n) return false;
+    uint8_t dcs = b[pos + 1];
+    if (!decodeTimestamp(b + pos + 2, message.timestamp)) return false;
+    uint8_t udl = b[pos + 9];
+    pos += 10;
+
+    enum { ALPHABET_GSM7, ALPHABET_8BIT, ALPHABET_UCS2 } alphabet = ALPHABET_GSM7;
+    if ((dcs & 0x80) == 0) {
+        uint8_t a = (dcs >> 2) & 0x03;
+        alphabet = a == 1 ? ALPHABET_8BIT : a == 2 ? ALPHABET_UCS2 : ALPHABET_GSM7;
+    } else if ((dcs & 0xF0) == 0xF0) {
+        alphabet = (dcs & 0x04) ? ALPHABET_8BIT : ALPHABET_GSM7;
+    } else if ((dcs & 0xF0) == 0xE0) {
+        alphabet = ALPHABET_UCS2;
+    }
+
+    size_t udBytes = alphabet == ALPHABET_GSM7 ? ((size_t)udl * 7 + 7) / 8 : udl;
+    if (pos + udBytes > n) return false;
+    const uint8_t* ud = b + pos;
+
+    // 用户数据头：连接短信信息单元（8位或16位参考号）
+    size_t headerBytes = 0;
+    message.reference = 0;
+    message.total = 1;
+    message.sequence = 1;
+    if (firstOctet & 0x40) {
+        if (udBytes < 1 || (size_t)ud[0] + 1 > udBytes) return false;
+        headerBytes = ud[0] + 1;
+        for (size_t i = 1; i + 1 < headerBytes; i += 2 + ud[i + 1]) {
+            uint8_t iei = ud[i];
+            uint8_t iel = ud[i + 1];
+            if (i + 2 + iel > headerBytes) break;
+            if (iei == 0x00 && iel == 3) {
+                message.reference = ud[i + 2];
+                message.total = ud[i + 3];
+                message.sequence = ud[i + 4];
+            } else if (iei == 0x08 && iel == 4) {
+                message.reference = ((uint16_t)ud[i + 2] << 8) | ud[i + 3];
+                message.total = ud[i + 4];
+                message.sequence = ud[i + 5];
+            }
+        }
+    }
+
+    // 最长160个7位字符，含扩展字符在内每个最多3字节
+    char text[160 * 3];
+    size_t textLen;
+    if (alphabet == ALPHABET_GSM7) {
+        uint8_t septets[160];
+        // 头部之后补齐到7位边界
+        size_t skip = (headerBytes * 8 + 6) / 7;
+        size_t count = unpackSeptets(ud, udBytes, udl, skip, septets, sizeof(septets));
+        textLen = gsm7ToUtf8(septets, count, text, sizeof(text));
+    } else if (alphabet == ALPHABET_UCS2) {
+        textLen = ucs2ToUtf8(ud + headerBytes, udBytes - headerBytes, text, sizeof(text));
+    } else {
+        textLen = latin1ToUtf8(ud + headerBytes, udBytes - headerBytes, text, sizeof(text));
+    }
+    message.text = "";
+    message.text.reserve(textLen);
+    message.text.concat(text, textLen);
+    return true;
+}
+
+SmsAssembler::SmsAssembler() : dropped(0) {
+    for (int i = 0; i < SMS_MAX_PENDING; i++) {
+        slots[i].used = false;
+    }
+}
+
+SmsAssembler::Slot* SmsAssembler::find(const SmsMessage& part) {
+    for (int i = 0; i < SMS_MAX_PENDING; i++) {
+        Slot& s = slots[i];
+        if (s.used && s.reference == part.reference && s.total == part.total && s.sender == part.sender) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+bool SmsAssembler::add(const SmsMessage& part, SmsMessage& complete) {
+    if (part.total <= 1) {
+        complete = part;
+        return true;
+    }
+    if (part.total > SMS_MAX_PARTS || part.sequence == 0 || part.sequence > part.total) {
+        dropped++;
+        return false;
+    }
+    expire();
+
+    Slot* slot = find(part);
+    if (slot == nullptr) {
+        // 取空闲的位置，没有时覆盖最早开始的消息
+        Slot* oldest = nullptr;
+        for (int i = 0; i < SMS_MAX_PENDING && slot == nullptr; i++) {
+            if (!slots[i].used) slot = &slots[i];
+            else if (oldest == nullptr || millis() - slots[i].started > millis() - oldest->started) oldest = &slots[i];
+        }
+        if (slot == nullptr) {
+            slot = oldest;
+            dropped++;
+        }
+        slot->used = true;
+        slot->sender = part.sender;
+        slot->timestamp = part.timestamp;
+        slot->reference = part.reference;
+        slot->total = part.total;
+        slot->received = 0;
+        slot->mask = 0;
+        slot->started = millis();
+    }
+
+    uint8_t bit = 1 << (part.sequence - 1);
+    if (!(slot->mask & bit)) {
+        slot->parts[part.sequence - 1] = part.text;
+        slot->mask |= bit;
+        slot->received++;
+    }
+    if (part.sequence == 1) slot->timestamp = part.timestamp;
+    if (slot->received < slot->total) return false;
+
+    // 按序号合并，一次分配
+    size_t len = 0;
+    for (uint8_t i = 0; i < slot->total; i++) len += slot->parts[i].length();
+    complete.text = "";
+    complete.text.reserve(len);
+    for (uint8_t i = 0; i < slot->total; i++) {
+        complete.text.concat(slot->parts[i].c_str(), slot->parts[i].length());
+        slot->parts[i] = String();
+    }
+    complete.sender = slot->sender;
+    complete.timestamp = slot->timestamp;
+    complete.reference = slot->reference;
+    complete.total = slot->total;
+    complete.sequence = 1;
+    slot->used = false;
+    return true;
+}
+
+size_t SmsAssembler::expire() {
+    size_t n = 0;
+    for (int i = 0; i < SMS_MAX_PENDING; i++) {
+        Slot& s = slots[i];
+        if (s.used && millis() - s.started >= SMS_ASSEMBLY_TIMEOUT_MS) {
+            for (uint8_t k = 0; k < SMS_MAX_PARTS; k++) s.parts[k] = String();
+            s.used = false;
+            dropped++;
+            n++;
+        }
+    }
+    return n;
+}
+
+size_t SmsAssembler::pending() const {
+    size_t n = 0;
+    for (int i = 0; i < SMS_MAX_PENDING; i++) {
+        if (slots[i].used) n++;
+    }
+    return n;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Arduino.h>
+
+// 长短信重组时同时缓存的消息数和每条消息的最大分段数
+#define SMS_MAX_PENDING 4
+#define SMS_MAX_PARTS 8
+// 分段到齐的最长等待时间，超时的不完整消息被丢弃
+#define SMS_ASSEMBLY_TIMEOUT_MS 600000UL
+// 单条 PDU 的最大字节数（SMSC 12 + TPDU 164）
+#define SMS_MAX_PDU_BYTES 176
+
+// 一条 SMS-DELIVER 短信（或长短信的一段）
+struct SmsMessage {
+    String sender;          // 发送方号码，国际号码带 +；字母数字地址解码为文本
+    String timestamp;       // 服务中心时间戳 "YY/MM/DD,hh:mm:ss+zz"，zz 为时区（15分钟为单位）
+    String text;            // UTF-8 正文
+    uint16_t reference;     // 长短信参考号，单条短信为0
+    uint8_t total;          // 分段总数，单条短信为1
+    uint8_t sequence;       // 分段序号，从1开始
+};
+
+// PDU 短信解码：GSM 7位默认字母表（含扩展表）、8位数据和 UCS2（含代理对）转 UTF-8。
+// 字符映射和十六进制解析都查表完成，输出 String 按上界预留一次容量后
+// 分块追加，不逐字符 +=
+class PDUHelper {
+public:
+    // 十六进制 UCS2（每4位一个码元）或8位字节转 UTF-8。
+    // 长度为4的倍数且按 UCS2 解码没有控制字符和孤立代理时按 UCS2，否则按字节（Latin-1）；
+    // 不是十六进制串时原样返回
+    static String decodeHexToString(const String& hex);
+
+    // 文本模式（AT+CMGF=1）下读到的正文：十六进制时解码，否则原样返回，去掉结尾的回车换行
+    static String decodeContent(const String& content);
+
+    // 解析 AT+CMGR/+CMGL 输出的 PDU 十六进制串（含 SMSC 前缀），只支持 SMS-DELIVER
+    static bool decodePdu(const String& pdu, SmsMessage& message);
+    static bool decodePdu(const char* hex, size_t len, SmsMessage& message);
+
+    // 把 septets 个7位字符从 packed 中解出，跳过前 skip 个（用户数据头占用的部分），
+    // 结果为 GSM 字母表编码，返回写入的个数
+    static size_t unpackSeptets(const uint8_t* packed, size_t bytes, size_t septets, size_t skip,
+                                uint8_t* out, size_t size);
+
+    // GSM 字母表编码转 UTF-8，ESC(0x1B) 后跟扩展表字符。返回写入的字节数
+    static size_t gsm7ToUtf8(const uint8_t* septets, size_t count, char* out, size_t size);
+
+    // 大端 UCS2/UTF-16 字节转 UTF-8，代理对合并为一个字符，孤立代理替换为 U+FFFD
+    static size_t ucs2ToUtf8(const uint8_t* data, size_t bytes, char* out, size_t size);
+
+    // 十六进制转字节，遇到非十六进制字符时停止，返回字节数
+    static size_t hexToBytes(const char* hex, size_t len, uint8_t* out, size_t size);
+};
+
+// 长短信重组：按发送方和参考号缓存分段，集齐后按序号合并为一条消息。
+// 缓存满时丢弃最早开始的不完整消息
+class SmsAssembler {
+public:
+    SmsAssembler();
+
+    // 加入一段；单条短信或最后一段到达后返回true，complete 为完整消息
+    bool add(const SmsMessage& part, SmsMessage& complete);
+
+    // 丢弃超时的不完整消息，返回丢弃的个数
+    size_t expire();
+
+    size_t pending() const;
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    struct Slot {
+        bool used;
+        String sender;
+        String timestamp;       // 第一段的时间戳
+        uint16_t reference;
+        uint8_t total;
+        uint8_t received;
+        uint8_t mask;           // 已收到的分段
+        unsigned long started;
+        String parts[SMS_MAX_PARTS];
+    };
+
+    Slot slots[SMS_MAX_PENDING];
+    uint32_t dropped;
+
+    Slot* find(const SmsMessage& part);
+};
@@ -0,0 +1,73 @@
+#ifndef TEST_ADAFRUIT_BUSIO_REGISTER_H
+#define TEST_ADAFRUIT_BUSIO_REGISTER_H
+
+#include "Adafruit_I2CDevice.h"
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+class Adafruit_BusIO_Register {
+public:
+    Adafruit_BusIO_Register(Adafruit_I2CDevice* device, uint16_t reg, uint8_t width = 1,
+                            uint8_t byteOrder = LSBFIRST)
+        : device(device), reg(reg), width(width), byteOrder(byteOrder) {}
+
+    bool read(uint32_t* value) {
+        uint8_t out = (uint8_t)reg;
+        uint8_t in[4] = {0, 0, 0, 0};
+        if (!device->write_then_read(&out, 1, in, width)) return false;
+        *value = 0;
+        for (uint8_t i = 0; i < width; i++) {
+            uint8_t b = byteOrder == MSBFIRST ? in[i] : in[width - 1 - i];
+            *value = (*value << 8) | b;
+        }
+        return true;
+    }
+    bool read(uint16_t* value) {
+        uint32_t v;
+        if (!read(&v)) return false;
+        *value = (uint16_t)v;
+        return true;
+    }
+    uint32_t read() {
+        uint32_t v = 0;
+        read(&v);
+        return v;
+    }
+    bool write(uint32_t value, uint8_t numBytes = 0) {
+        if (numBytes == 0) numBytes = width;
+        uint8_t buffer[5];
+        buffer[0] = (uint8_t)reg;
+        for (uint8_t i = 0; i < numBytes; i++) {
+            uint8_t shift = byteOrder == MSBFIRST ? (numBytes - 1 - i) * 8 : i * 8;
+            buffer[1 + i] = (value >> shift) & 0xFF;
+        }
+        return device->write(buffer, 1 + numBytes);
+    }
+
+private:
+    Adafruit_I2CDevice* device;
+    uint16_t reg;
+    uint8_t width;
+    uint8_t byteOrder;
+};
+
+class Adafruit_BusIO_RegisterBits {
+public:
+    Adafruit_BusIO_RegisterBits(Adafruit_BusIO_Register* reg, uint8_t bits, uint8_t shift)
+        : reg(reg), bits(bits), shift(shift) {}
+
+    uint32_t read() { return (reg->read() >> shift) & ((1UL << bits) - 1); }
+    bool write(uint32_t value) {
+        uint32_t mask = ((1UL << bits) - 1) << shift;
+        uint32_t current = reg->read();
+        return reg->write((current & ~mask) | ((value << shift) & mask));
+    }
+
+private:
+    Adafruit_BusIO_Register* reg;
+    uint8_t bits;
+    uint8_t shift;
+};
+
+#endif // TEST_ADAFRUIT_BUSIO_REGISTER_H
@@ -0,0 +1,45 @@
+#ifndef TEST_ADAFRUIT_GFX_H
+#define TEST_ADAFRUIT_GFX_H
+
+#include <stdarg.h>
+#include "Arduino.h"
+
+// Adafruit GFX 的最小实现：只记录光标和文字属性，print 系列把文本交给 write()
+class Adafruit_GFX : public Print {
+public:
+    Adafruit_GFX(int16_t w, int16_t h) : width(w), height(h) {}
+
+    void setTextSize(uint8_t s) { textSize = s; }
+    void setTextColor(uint16_t c) { textColor = c; }
+    void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+
+    size_t print(const char* s) { return Print::write((const uint8_t*)s, strlen(s)); }
+    size_t print(const String& s) { return print(s.c_str()); }
+    size_t print(long v) { return printf("%ld", v); }
+    size_t print(int v) { return print((long)v); }
+    size_t print(unsigned long v) { return printf("%lu", v); }
+    size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+    template <typename T>
+    size_t println(T v) { return print(v) + print("\n"); }
+    size_t println(double v, int digits) { return print(v, digits) + print("\n"); }
+
+protected:
+    int16_t width;
+    int16_t height;
+    int16_t cursorX = 0;
+    int16_t cursorY = 0;
+    uint8_t textSize = 1;
+    uint16_t textColor = 1;
+
+private:
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        char buf[32];
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(buf, sizeof(buf), fmt, args);
+        va_end(args);
+        return print(buf);
+    }
+};
+
+#endif // TEST_ADAFRUIT_GFX_H
@@ -0,0 +1,38 @@
+#ifndef TEST_ADAFRUIT_I2CDEVICE_H
+#define TEST_ADAFRUIT_I2CDEVICE_H
+
+#include "Wire.h"
+
+// Adafruit BusIO 的最小实现，只覆盖 INA219 驱动用到的部分，经模拟的 Wire 传输
+class Adafruit_I2CDevice {
+public:
+    Adafruit_I2CDevice(uint8_t addr, TwoWire* theWire = &Wire) : address(addr), wire(theWire) {}
+
+    bool begin(bool addrDetect = true) {
+        wire->begin();
+        return !addrDetect || detected();
+    }
+    bool detected() {
+        wire->beginTransmission(address);
+        return wire->endTransmission() == 0;
+    }
+    bool write(const uint8_t* buffer, size_t len) {
+        wire->beginTransmission(address);
+        wire->write(buffer, len);
+        return wire->endTransmission() == 0;
+    }
+    bool read(uint8_t* buffer, size_t len) {
+        if (wire->requestFrom(address, (uint8_t)len) != len) return false;
+        for (size_t i = 0; i < len; i++) buffer[i] = wire->read();
+        return true;
+    }
+    bool write_then_read(const uint8_t* out, size_t outLen, uint8_t* in, size_t inLen) {
+        return write(out, outLen) && read(in, inLen);
+    }
+
+private:
+    uint8_t address;
+    TwoWire* wire;
+};
+
+#endif // TEST_ADAFRUIT_I2CDEVICE_H
@@ -0,0 +1,48 @@
+#ifndef TEST_ADAFRUIT_SSD1306_H
+#define TEST_ADAFRUIT_SSD1306_H
+
+#include <algorithm>
+#include <vector>
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR 0x22
+
+// SSD1306 的帧缓冲模拟：不做字形渲染，每个字符按字节值写入光标所在的一列，
+// 文本变化时帧缓冲随之变化，足以驱动 Display 的差异刷新
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* /*twi*/ = &Wire, int8_t /*rst*/ = -1,
+                     uint32_t /*clkDuring*/ = 400000, uint32_t /*clkAfter*/ = 100000)
+        : Adafruit_GFX(w, h), buffer(w * ((h + 7) / 8)) {}
+
+    bool begin(uint8_t /*vcc*/ = SSD1306_SWITCHCAPVCC, uint8_t /*addr*/ = 0, bool /*reset*/ = true,
+               bool /*periphBegin*/ = true) {
+        return true;
+    }
+    void clearDisplay() { std::fill(buffer.begin(), buffer.end(), 0); }
+    void display() {}
+    uint8_t* getBuffer() { return buffer.data(); }
+
+    using Print::write;
+    size_t write(uint8_t c) override {
+        if (c == '\n') {
+            cursorX = 0;
+            cursorY += 8 * textSize;
+            return 1;
+        }
+        size_t index = (cursorY / 8) * width + cursorX;
+        if (cursorX < width && index < buffer.size()) buffer[index] = c;
+        cursorX += 6 * textSize;
+        return 1;
+    }
+
+private:
+    std::vector<uint8_t> buffer;
+};
+
+#endif // TEST_ADAFRUIT_SSD1306_H
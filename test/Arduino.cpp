@@ -1,15 +1,54 @@
 #include "Arduino.h"
-#include <unistd.h>
-#include <sys/time.h>
+#include "Updater.h"
 
 SerialClass Serial;
+EspClass ESP;
+UpdaterClass Update;
+
+uint64_t SimClock::now = 0;
+
+static uint8_t pinValues[32];
+static uint8_t pinModes[32];
 
 void delay(unsigned long ms) {
-    usleep(ms * 1000);
+    SimClock::advanceMillis(ms);
+}
+
+void delayMicroseconds(unsigned int us) {
+    SimClock::advance(us);
 }
 
 unsigned long millis() {
-    struct timeval tv;
-    gettimeofday(&tv, nullptr);
-    return (tv.tv_sec * 1000) + (tv.tv_usec / 1000);
-} 
\ No newline at end of file
+    return (unsigned long)(SimClock::now / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)SimClock::now;
+}
+
+void yield() {
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < 32) pinModes[pin] = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < 32) pinValues[pin] = value;
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= 32) return LOW;
+    return pinModes[pin] == OUTPUT ? pinValues[pin] : HIGH;
+}
+
+void attachInterrupt(uint8_t /*interrupt*/, void (* /*handler*/)(), int /*mode*/) {
+}
+
+long random(long max) {
+    return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max) {
+    return min + random(max - min);
+}
@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
 
 class String {
 private:
@@ -74,6 +75,9 @@ public:
 
     bool isEmpty() const { return buffer[0] == '\0'; }
 
+    long toInt() const { return atol(buffer); }
+    float toFloat() const { return atof(buffer); }
+
     void clear() {
         delete[] buffer;
         buffer = new char[1];
@@ -132,6 +136,29 @@ public:
         return *this;
     }
 
+    // 与 Arduino 一致：预留容量后 concat 不再重新分配
+    bool reserve(unsigned int size) {
+        if (bufferSize >= size + 1) return true;
+        char* temp = new char[size + 1];
+        strcpy(temp, buffer);
+        delete[] buffer;
+        buffer = temp;
+        bufferSize = size + 1;
+        return true;
+    }
+
+    bool concat(const char* s) { return concat(s, strlen(s)); }
+    bool concat(const char* s, unsigned int len) {
+        size_t len1 = length();
+        if (len1 + len + 1 > bufferSize) {
+            size_t grow = bufferSize * 2 > len1 + len + 1 ? bufferSize * 2 : len1 + len + 1;
+            reserve(grow - 1);
+        }
+        memcpy(buffer + len1, s, len);
+        buffer[len1 + len] = '\0';
+        return true;
+    }
+
     String& operator+=(char rhs) {
         size_t len1 = length();
         char* temp = new char[len1 + 2];
@@ -219,7 +246,7 @@ public:
     bool startsWith(const char* prefix) const {
         if (!prefix) return false;
         size_t prefixLen = strlen(prefix);
-        if (prefixLen > length()) return false;
+        if (prefixLen > (size_t)length()) return false;
         return strncmp(buffer, prefix, prefixLen) == 0;
     }
 
@@ -233,18 +260,66 @@ public:
     }
 };
 
+// ArduinoJson 的 Arduino 字符串适配会引用该类型，这里不需要其定义
+class StringSumHelper;
+
 // Global operator+ for string concatenation
 inline String operator+(const char* lhs, const String& rhs) {
     return String(lhs) + rhs;
 }
 
+// 输出/输入流基类，供 ArduinoJson 直接读写文件
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* data, size_t len) {
+        size_t n = 0;
+        while (n < len && write(data[n])) n++;
+        return n;
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    size_t readBytes(char* buffer, size_t len) {
+        size_t n = 0;
+        int c;
+        while (n < len && (c = read()) >= 0) buffer[n++] = (char)c;
+        return n;
+    }
+    size_t readBytes(uint8_t* buffer, size_t len) { return readBytes((char*)buffer, len); }
+};
+
 class SerialClass {
 public:
+    void begin(unsigned long) {}
+    void setRxBufferSize(size_t) {}
     void print(const char* s) { printf("%s", s); }
     void print(const String& s) { printf("%s", s.c_str()); }
+    void print(int v) { printf("%d", v); }
+    void print(long v) { printf("%ld", v); }
+    void print(unsigned int v) { printf("%u", v); }
+    void print(unsigned long v) { printf("%lu", v); }
+    void print(double v, int digits = 2) { printf("%.*f", digits, v); }
     void println(const char* s) { printf("%s\n", s); }
     void println(const String& s) { printf("%s\n", s.c_str()); }
+    void println(int v) { printf("%d\n", v); }
+    void println(long v) { printf("%ld\n", v); }
+    void println(unsigned int v) { printf("%u\n", v); }
+    void println(unsigned long v) { printf("%lu\n", v); }
+    // IPAddress 等可转为文本的对象
+    template <typename T>
+    void println(const T& v) { println(v.toString()); }
     void println() { printf("\n"); }
+    // 发送缓冲总是空闲，日志输出不会被截断
+    int availableForWrite() { return 128; }
+    size_t write(const uint8_t* data, size_t len) { return fwrite(data, 1, len, stdout); }
+    size_t write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; }
+    void flush() { fflush(stdout); }
 };
 
 extern SerialClass Serial;
@@ -254,9 +329,84 @@ extern SerialClass Serial;
 #define LOW  0x0
 #define INPUT 0x0
 #define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+// 主机上没有闪存常量区，PSTR 等直接使用普通字符串
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define IRAM_ATTR
+typedef const char* PGM_P;
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+
+// 模拟时钟：millis()/micros()/ESP.getCycleCount() 都来自 SimClock，
+// delay() 推进模拟时间而不睡眠，测试可以精确控制时间
+class SimClock {
+public:
+    static uint64_t now;    // μs
+    static void advance(uint64_t us) { now += us; }
+    static void advanceMillis(unsigned long ms) { now += (uint64_t)ms * 1000; }
+};
 
 void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
 unsigned long millis();
+unsigned long micros();
+void yield();
+
+// 模拟的 80MHz CPU
+class EspClass {
+public:
+    uint32_t getCycleCount() { return (uint32_t)(SimClock::now * 80); }
+    uint8_t getCpuFreqMHz() { return 80; }
+    uint32_t getChipId() { return 0xC0FFEE; }
+    // 堆状态由测试设置；碎片率按 100 - 最大块/可用堆 近似
+    uint32_t freeHeap = 40000;
+    uint32_t maxFreeBlock = 30000;
+    uint32_t getFreeHeap() { return freeHeap; }
+    uint32_t getMaxFreeBlockSize() { return maxFreeBlock; }
+    uint8_t getHeapFragmentation() { return freeHeap ? 100 - maxFreeBlock * 100 / freeHeap : 0; }
+    void getHeapStats(uint32_t* free, uint32_t* max, uint8_t* frag) {
+        if (free) *free = getFreeHeap();
+        if (max) *max = getMaxFreeBlockSize();
+        if (frag) *frag = getHeapFragmentation();
+    }
+    uint32_t getFreeSketchSpace() { return 1024 * 1024; }
+    void restart() {}
+};
+
+extern EspClass ESP;
+
+// 看门狗与 NTP：主机上无操作，time() 直接使用主机时间
+#define WDTO_15MS 0
+inline void wdt_disable() {}
+inline void wdt_enable(int) {}
+inline void configTime(long, int, const char*, const char* = nullptr, const char* = nullptr) {}
+
+// 引脚：输出值保存在数组中，输入默认读回高电平（上拉）
+#define SDA 4
+#define SCL 5
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*handler)(), int mode);
+#define digitalPinToInterrupt(p) (p)
+
+long random(long max);
+long random(long min, long max);
+
+template <typename T, typename L, typename H>
+inline T constrain(T value, L low, H high) {
+    return value < low ? low : (value > high ? high : value);
+}
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
 
 #define HEX 16
 #define DEC 10
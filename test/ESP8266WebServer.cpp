@@ -0,0 +1,132 @@
+#include "ESP8266WebServer.h"
+
+static std::map<int, ESP8266WebServer*> servers;
+
+void ESP8266WebServer::begin() {
+    servers[port] = this;
+}
+
+void ESP8266WebServer::stop() {
+    std::map<int, ESP8266WebServer*>::iterator it = servers.find(port);
+    if (it != servers.end() && it->second == this) servers.erase(it);
+}
+
+ESP8266WebServer* ESP8266WebServer::listening(int port) {
+    std::map<int, ESP8266WebServer*>::iterator it = servers.find(port);
+    return it != servers.end() ? it->second : nullptr;
+}
+
+void ESP8266WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler) {
+    Route r;
+    r.uri = uri.c_str();
+    r.method = method;
+    r.handler = handler;
+    routes.push_back(r);
+}
+
+bool ESP8266WebServer::hasArg(const String& name) const {
+    for (size_t i = 0; i < requestArgs.size(); i++) {
+        if (requestArgs[i].first == name.c_str()) return true;
+    }
+    return false;
+}
+
+String ESP8266WebServer::arg(const String& name) const {
+    for (size_t i = 0; i < requestArgs.size(); i++) {
+        if (requestArgs[i].first == name.c_str()) return String(requestArgs[i].second.c_str());
+    }
+    return String();
+}
+
+String ESP8266WebServer::arg(int index) const {
+    if (index < 0 || index >= args()) return String();
+    return String(requestArgs[index].second.c_str());
+}
+
+String ESP8266WebServer::argName(int index) const {
+    if (index < 0 || index >= args()) return String();
+    return String(requestArgs[index].first.c_str());
+}
+
+bool ESP8266WebServer::hasHeader(const String& name) const {
+    for (size_t i = 0; i < requestHeaders.size(); i++) {
+        if (strcasecmp(requestHeaders[i].first.c_str(), name.c_str()) == 0) return true;
+    }
+    return false;
+}
+
+String ESP8266WebServer::header(const String& name) const {
+    for (size_t i = 0; i < requestHeaders.size(); i++) {
+        if (strcasecmp(requestHeaders[i].first.c_str(), name.c_str()) == 0) {
+            return String(requestHeaders[i].second.c_str());
+        }
+    }
+    return String();
+}
+
+void ESP8266WebServer::send(int code, const char* type, const String& content) {
+    response.code = code;
+    response.type = type != nullptr ? type : "";
+    chunked = contentLength == CONTENT_LENGTH_UNKNOWN;
+    response.body = content.c_str();
+}
+
+void ESP8266WebServer::send(int code, const char* type, const char* content, size_t length) {
+    response.code = code;
+    response.type = type != nullptr ? type : "";
+    chunked = false;
+    response.body.assign(content, length);
+}
+
+void ESP8266WebServer::sendContent(const char* content, size_t len) {
+    // 分块模式下空块表示结束
+    if (chunked && len == 0) return;
+    response.body.append(content, len);
+    response.chunks++;
+}
+
+ESP8266WebServer::Response ESP8266WebServer::request(
+        HTTPMethod method, const char* uri,
+        const std::vector<std::pair<std::string, std::string> >& headers) {
+    std::string path = uri;
+    requestArgs.clear();
+    size_t q = path.find('?');
+    if (q != std::string::npos) {
+        std::string query = path.substr(q + 1);
+        path.erase(q);
+        size_t start = 0;
+        while (start <= query.size()) {
+            size_t end = query.find('&', start);
+            if (end == std::string::npos) end = query.size();
+            std::string pair = query.substr(start, end - start);
+            size_t eq = pair.find('=');
+            if (!pair.empty()) {
+                requestArgs.push_back(eq == std::string::npos
+                                      ? std::make_pair(pair, std::string())
+                                      : std::make_pair(pair.substr(0, eq), pair.substr(eq + 1)));
+            }
+            start = end + 1;
+        }
+    }
+    requestUri = path;
+    requestMethod = method;
+    requestHeaders = headers;
+    contentLength = 0;
+    chunked = false;
+    response = Response();
+    response.code = 0;
+    response.chunks = 0;
+
+    for (size_t i = 0; i < routes.size(); i++) {
+        if (routes[i].uri == path && (routes[i].method == HTTP_ANY || routes[i].method == method)) {
+            routes[i].handler();
+            return response;
+        }
+    }
+    if (notFound) {
+        notFound();
+    } else {
+        send(404, "text/plain", "Not found");
+    }
+    return response;
+}
@@ -0,0 +1,129 @@
+#ifndef TEST_ESP8266WEBSERVER_H
+#define TEST_ESP8266WEBSERVER_H
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+enum HTTPMethod {
+    HTTP_ANY,
+    HTTP_GET,
+    HTTP_HEAD,
+    HTTP_POST,
+    HTTP_PUT,
+    HTTP_PATCH,
+    HTTP_DELETE,
+    HTTP_OPTIONS
+};
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+
+enum HTTPUploadStatus {
+    UPLOAD_FILE_START,
+    UPLOAD_FILE_WRITE,
+    UPLOAD_FILE_END,
+    UPLOAD_FILE_ABORTED
+};
+
+struct HTTPUpload {
+    HTTPUploadStatus status;
+    String filename;
+    String name;
+    String type;
+    size_t totalSize;
+    size_t currentSize;
+    uint8_t buf[2048];
+};
+
+// 进程内的 Web 服务器：request() 按路由调用处理函数并收集响应，
+// 分块发送（CONTENT_LENGTH_UNKNOWN）时把各块拼接为完整正文
+class ESP8266WebServer {
+public:
+    typedef std::function<void()> THandlerFunction;
+
+    struct Response {
+        int code;
+        std::string type;
+        std::string body;
+        size_t chunks;      // sendContent() 调用次数，不含结束块
+        std::map<std::string, std::string> headers;
+    };
+
+    explicit ESP8266WebServer(int port = 80) : port(port) {}
+    ~ESP8266WebServer() { stop(); }
+
+    // begin() 后可按端口找到服务器，测试借此向组件内部持有的服务器发请求
+    void begin();
+    void stop();
+    static ESP8266WebServer* listening(int port);
+    void handleClient() {}
+    void on(const String& uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+    void on(const String& uri, HTTPMethod method, THandlerFunction handler);
+    // 上传处理函数只登记，request() 不模拟文件上传
+    void on(const String& uri, HTTPMethod method, THandlerFunction handler, THandlerFunction /*uploadHandler*/) {
+        on(uri, method, handler);
+    }
+    HTTPUpload& upload() { return currentUpload; }
+    void onNotFound(THandlerFunction handler) { notFound = handler; }
+
+    // 请求参数与头
+    bool hasArg(const String& name) const;
+    String arg(const String& name) const;
+    String arg(int index) const;
+    String argName(int index) const;
+    int args() const { return (int)requestArgs.size(); }
+    String uri() const { return String(requestUri.c_str()); }
+    HTTPMethod method() const { return requestMethod; }
+    bool hasHeader(const String& name) const;
+    String header(const String& name) const;
+    void collectHeaders(const char* /*headers*/[], size_t /*count*/) {}
+
+    // 响应
+    void setContentLength(size_t length) { contentLength = length; }
+    void sendHeader(const String& name, const String& value, bool /*first*/ = false) {
+        response.headers[name.c_str()] = value.c_str();
+    }
+    void send(int code, const char* type = nullptr, const String& content = String());
+    void send(int code, const String& type, const String& content) { send(code, type.c_str(), content); }
+    void send(int code, const char* type, const char* content, size_t length);
+    void send_P(int code, PGM_P type, PGM_P content) { send(code, type, String(content)); }
+    void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+    void sendContent(const char* content, size_t len);
+    void sendContent_P(PGM_P content) { sendContent(content, strlen(content)); }
+    template <typename T>
+    size_t streamFile(T& file, const String& type, int code = 200) {
+        std::string body;
+        int c;
+        while ((c = file.read()) >= 0) body += (char)c;
+        send(code, type.c_str(), body.data(), body.size());
+        return body.size();
+    }
+
+    // 模拟一次请求，uri 可带 ?a=1&b=2 查询参数；headers 为 {"名称", "值"} 对
+    Response request(HTTPMethod method, const char* uri,
+                     const std::vector<std::pair<std::string, std::string> >& headers =
+                         std::vector<std::pair<std::string, std::string> >());
+
+private:
+    struct Route {
+        std::string uri;
+        HTTPMethod method;
+        THandlerFunction handler;
+    };
+
+    int port;
+    HTTPUpload currentUpload;
+    std::vector<Route> routes;
+    THandlerFunction notFound;
+    std::string requestUri;
+    HTTPMethod requestMethod = HTTP_GET;
+    std::vector<std::pair<std::string, std::string> > requestArgs;
+    std::vector<std::pair<std::string, std::string> > requestHeaders;
+    size_t contentLength = 0;
+    bool chunked = false;
+    Response response;
+};
+
+#endif // TEST_ESP8266WEBSERVER_H
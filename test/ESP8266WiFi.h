@@ -0,0 +1,94 @@
+#ifndef TEST_ESP8266WIFI_H
+#define TEST_ESP8266WIFI_H
+
+#include <map>
+#include <string>
+#include "Arduino.h"
+
+class IPAddress {
+public:
+    IPAddress() : value(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : value((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+
+    bool fromString(const char* s) {
+        unsigned a, b, c, d;
+        char tail;
+        if (sscanf(s, "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4 || a > 255 || b > 255 || c > 255 || d > 255) {
+            return false;
+        }
+        *this = IPAddress(a, b, c, d);
+        return true;
+    }
+    bool fromString(const String& s) { return fromString(s.c_str()); }
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", value & 0xFF, (value >> 8) & 0xFF,
+                 (value >> 16) & 0xFF, value >> 24);
+        return String(buf);
+    }
+    operator uint32_t() const { return value; }
+    bool operator==(const IPAddress& other) const { return value == other.value; }
+
+private:
+    uint32_t value;
+};
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} WiFiMode_t;
+
+class WiFiClient {
+public:
+    void setTimeout(unsigned long ms) { timeout = ms; }
+    unsigned long getTimeout() const { return timeout; }
+
+private:
+    unsigned long timeout = 1000;
+};
+
+// WiFi 模拟：测试直接设置连接状态和 DNS 表，hostByName 按设置推进模拟时间
+class WiFiClass {
+public:
+    wl_status_t status() { return connected ? WL_CONNECTED : WL_DISCONNECTED; }
+    int hostByName(const char* host, IPAddress& result, uint32_t timeoutMs = 10000) {
+        delay(dnsDelayMs < timeoutMs ? dnsDelayMs : timeoutMs);
+        std::map<std::string, IPAddress>::iterator it = hosts.find(host);
+        if (!connected || it == hosts.end()) return 0;
+        result = it->second;
+        return 1;
+    }
+    bool mode(WiFiMode_t m) { wifiMode = m; return true; }
+    WiFiMode_t getMode() const { return wifiMode; }
+    wl_status_t begin(const char*, const char*) { return status(); }
+    bool disconnect(bool = false) { connected = false; return true; }
+    bool softAP(const char*, const char* = nullptr, int = 1) { return true; }
+    bool softAPdisconnect(bool = false) { return true; }
+    IPAddress localIP() { return IPAddress(192, 168, 1, 50); }
+    IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+    String SSID() { return String("simnet"); }
+    int32_t RSSI() { return -55; }
+
+    // 模拟控制
+    bool connected = true;
+    uint32_t dnsDelayMs = 0;
+    std::map<std::string, IPAddress> hosts;
+
+private:
+    WiFiMode_t wifiMode = WIFI_STA;
+};
+
+extern WiFiClass WiFi;
+
+#endif // TEST_ESP8266WIFI_H
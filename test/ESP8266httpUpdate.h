@@ -0,0 +1,7 @@
+#ifndef TEST_ESP8266HTTPUPDATE_H
+#define TEST_ESP8266HTTPUPDATE_H
+
+// 主机上没有 HTTP 升级，只提供 Update（上传升级用）
+#include "Updater.h"
+
+#endif // TEST_ESP8266HTTPUPDATE_H
@@ -0,0 +1,29 @@
+#ifndef TEST_EASYLED_H
+#define TEST_EASYLED_H
+
+#include "Arduino.h"
+
+// EasyLed 的最小实现：只记录亮灭状态和闪烁次数，不做延时
+class EasyLed {
+public:
+    enum class ActiveLevel { Low, High };
+    enum class State { Off, On };
+
+    EasyLed(uint8_t /*pin*/, ActiveLevel /*level*/, State initial = State::Off) : lit(initial == State::On) {}
+
+    void on() { lit = true; }
+    void off() { lit = false; }
+    void toggle() { lit = !lit; }
+    bool isOn() const { return lit; }
+    void flash(uint8_t count = 2, uint16_t /*onMs*/ = 200, uint16_t /*offMs*/ = 200,
+               uint16_t /*pauseBefore*/ = 0, uint16_t /*pauseAfter*/ = 0) {
+        flashes += count;
+    }
+
+    uint32_t flashes = 0;
+
+private:
+    bool lit;
+};
+
+#endif // TEST_EASYLED_H
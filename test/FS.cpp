@@ -0,0 +1,105 @@
+#include "FS.h"
+#include <stdlib.h>
+#include <string>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+fs::FS SPIFFS;
+
+static std::string hostPath(fs::FS& fs, const char* path) {
+    std::string p = fs.root();
+    if (path[0] != '/') p += '/';
+    return p + path;
+}
+
+namespace fs {
+
+size_t File::size() const {
+    if (!fp) return 0;
+    struct stat st;
+    fflush(fp.get());
+    return fstat(fileno(fp.get()), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+// 进程退出时删除临时目录及其中的文件
+static void removeRoot() {
+    SPIFFS.format();
+    rmdir(SPIFFS.root());
+}
+
+const char* FS::root() {
+    static std::string dir;
+    if (dir.empty()) {
+        char tmpl[] = "/tmp/spiffs-XXXXXX";
+        const char* made = mkdtemp(tmpl);
+        dir = made != nullptr ? made : "/tmp";
+        if (made != nullptr) atexit(removeRoot);
+    }
+    return dir.c_str();
+}
+
+bool FS::format() {
+    DIR* d = opendir(root());
+    if (d == nullptr) return false;
+    struct dirent* e;
+    while ((e = readdir(d)) != nullptr) {
+        if (e->d_name[0] == '.') continue;
+        unlink((std::string(root()) + "/" + e->d_name).c_str());
+    }
+    closedir(d);
+    return true;
+}
+
+File FS::open(const char* path, const char* mode) {
+    opens++;
+    std::string m = mode;
+    if (m.find('b') == std::string::npos) m += 'b';
+    FILE* fp = fopen(hostPath(*this, path).c_str(), m.c_str());
+    return fp != nullptr ? File(fp) : File();
+}
+
+bool FS::exists(const char* path) {
+    struct stat st;
+    return stat(hostPath(*this, path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+    return unlink(hostPath(*this, path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    return ::rename(hostPath(*this, from).c_str(), hostPath(*this, to).c_str()) == 0;
+}
+
+// 模拟一个 1MB 的分区，已用空间为目录中文件的总长度
+bool FS::info(FSInfo& info) {
+    Dir dir = openDir("/");
+    memset(&info, 0, sizeof(info));
+    info.totalBytes = 1024 * 1024;
+    while (dir.next()) info.usedBytes += dir.fileSize();
+    info.blockSize = 8192;
+    info.pageSize = 256;
+    info.maxOpenFiles = 5;
+    info.maxPathLength = 32;
+    return true;
+}
+
+Dir FS::openDir(const char* /*path*/) {
+    Dir dir;
+    DIR* d = opendir(root());
+    if (d == nullptr) return dir;
+    struct dirent* e;
+    while ((e = readdir(d)) != nullptr) {
+        if (e->d_name[0] == '.') continue;
+        struct stat st;
+        std::string name = std::string("/") + e->d_name;
+        if (stat(hostPath(*this, name.c_str()).c_str(), &st) == 0) {
+            dir.entries.push_back(std::make_pair(name, (size_t)st.st_size));
+        }
+    }
+    closedir(d);
+    return dir;
+}
+
+} // namespace fs
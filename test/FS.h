@@ -0,0 +1,106 @@
+#ifndef TEST_FS_H
+#define TEST_FS_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+// SPIFFS 模拟：文件保存在临时目录中（首次使用时创建），
+// 路径直接拼接在目录之后，与 SPIFFS 一样没有子目录
+namespace fs {
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+class File : public Stream {
+public:
+    File() {}
+    explicit File(FILE* fp) : fp(fp, fclose) {}
+
+    operator bool() const { return (bool)fp; }
+
+    size_t write(uint8_t c) override { return fp && fputc(c, fp.get()) != EOF ? 1 : 0; }
+    size_t write(const uint8_t* data, size_t len) override { return fp ? fwrite(data, 1, len, fp.get()) : 0; }
+    size_t read(uint8_t* data, size_t len) { return fp ? fread(data, 1, len, fp.get()) : 0; }
+    int read() override { return fp ? fgetc(fp.get()) : -1; }
+    int peek() override {
+        if (!fp) return -1;
+        int c = fgetc(fp.get());
+        if (c != EOF) ungetc(c, fp.get());
+        return c;
+    }
+    int available() override { return fp ? (int)(size() - position()) : 0; }
+    bool seek(uint32_t pos, SeekMode mode = SeekSet) {
+        return fp && fseek(fp.get(), pos, mode == SeekSet ? SEEK_SET : (mode == SeekCur ? SEEK_CUR : SEEK_END)) == 0;
+    }
+    size_t position() const { return fp ? (size_t)ftell(fp.get()) : 0; }
+    size_t size() const;
+    void flush() { if (fp) fflush(fp.get()); }
+    void close() { fp.reset(); }
+
+private:
+    std::shared_ptr<FILE> fp;
+};
+
+struct FSInfo {
+    size_t totalBytes;
+    size_t usedBytes;
+    size_t blockSize;
+    size_t pageSize;
+    size_t maxOpenFiles;
+    size_t maxPathLength;
+};
+
+// 目录遍历：openDir() 时取得文件列表快照
+class Dir {
+public:
+    bool next() { return ++index < (int)entries.size(); }
+    String fileName() const { return String(entries[index].first.c_str()); }
+    size_t fileSize() const { return entries[index].second; }
+
+private:
+    friend class FS;
+    std::vector<std::pair<std::string, size_t> > entries;
+    int index = -1;
+};
+
+class FS {
+public:
+    bool begin() { return true; }
+    void end() {}
+    bool format();
+    File open(const char* path, const char* mode);
+    File open(const String& path, const char* mode) { return open(path.c_str(), mode); }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to);
+    bool info(FSInfo& info);
+    Dir openDir(const char* path);
+
+    // 模拟文件系统所在的主机目录
+    const char* root();
+
+    // open() 的调用次数，测试用来检查闪存访问次数
+    uint32_t opens = 0;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::FSInfo;
+using fs::Dir;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+extern fs::FS SPIFFS;
+
+#endif // TEST_FS_H
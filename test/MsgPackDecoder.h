@@ -0,0 +1,211 @@
+#ifndef TEST_MSGPACK_DECODER_H
+#define TEST_MSGPACK_DECODER_H
+
+// 主机侧 MessagePack 解码器，用于验证设备输出并转换为 JSON 查看。
+// 支持设备端 MsgPackWriter 会产生的全部类型。
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <utility>
+
+struct MsgPackValue {
+    enum Type { NIL, BOOL, INT, STRING, ARRAY, MAP };
+    Type type = NIL;
+    int64_t i = 0;
+    std::string s;
+    std::vector<MsgPackValue> items;
+    std::vector<std::pair<std::string, MsgPackValue> > fields;
+
+    const MsgPackValue* get(const char* key) const {
+        for (size_t n = 0; n < fields.size(); n++) {
+            if (fields[n].first == key) return &fields[n].second;
+        }
+        return nullptr;
+    }
+
+    std::string toJson() const {
+        switch (type) {
+            case NIL: return "null";
+            case BOOL: return i ? "true" : "false";
+            case INT: return std::to_string(i);
+            case STRING: return "\"" + s + "\"";
+            case ARRAY: {
+                std::string out = "[";
+                for (size_t n = 0; n < items.size(); n++) {
+                    if (n) out += ",";
+                    out += items[n].toJson();
+                }
+                return out + "]";
+            }
+            case MAP: {
+                std::string out = "{";
+                for (size_t n = 0; n < fields.size(); n++) {
+                    if (n) out += ",";
+                    out += "\"" + fields[n].first + "\":" + fields[n].second.toJson();
+                }
+                return out + "}";
+            }
+        }
+        return "";
+    }
+};
+
+class MsgPackDecoder {
+public:
+    MsgPackDecoder(const uint8_t* data, size_t size) : data(data), size(size), pos(0), error(false) {}
+
+    bool decode(MsgPackValue& out) {
+        out = readValue();
+        return !error && pos == size;
+    }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    bool error;
+
+    uint64_t readBE(int bytes) {
+        uint64_t v = 0;
+        for (int n = 0; n < bytes; n++) {
+            if (pos >= size) {
+                error = true;
+                return 0;
+            }
+            v = (v << 8) | data[pos++];
+        }
+        return v;
+    }
+
+    MsgPackValue readString(size_t len) {
+        MsgPackValue v;
+        v.type = MsgPackValue::STRING;
+        if (pos + len > size) {
+            error = true;
+            return v;
+        }
+        v.s.assign((const char*)data + pos, len);
+        pos += len;
+        return v;
+    }
+
+    MsgPackValue readArray(size_t count) {
+        MsgPackValue v;
+        v.type = MsgPackValue::ARRAY;
+        for (size_t n = 0; n < count && !error; n++) v.items.push_back(readValue());
+        return v;
+    }
+
+    MsgPackValue readMap(size_t count) {
+        MsgPackValue v;
+        v.type = MsgPackValue::MAP;
+        for (size_t n = 0; n < count && !error; n++) {
+            MsgPackValue key = readValue();
+            if (key.type != MsgPackValue::STRING) {
+                error = true;
+                break;
+            }
+            v.fields.push_back(std::make_pair(key.s, readValue()));
+        }
+        return v;
+    }
+
+    static MsgPackValue makeInt(int64_t i) {
+        MsgPackValue v;
+        v.type = MsgPackValue::INT;
+        v.i = i;
+        return v;
+    }
+
+    MsgPackValue readValue() {
+        MsgPackValue v;
+        uint8_t b = (uint8_t)readBE(1);
+        if (error) return v;
+        if (b < 0x80) return makeInt(b);
+        if (b >= 0xE0) return makeInt((int8_t)b);
+        if ((b & 0xF0) == 0x80) return readMap(b & 0x0F);
+        if ((b & 0xF0) == 0x90) return readArray(b & 0x0F);
+        if ((b & 0xE0) == 0xA0) return readString(b & 0x1F);
+        switch (b) {
+            case 0xC0: return v;
+            case 0xC2: v.type = MsgPackValue::BOOL; v.i = 0; return v;
+            case 0xC3: v.type = MsgPackValue::BOOL; v.i = 1; return v;
+            case 0xCC: return makeInt((uint8_t)readBE(1));
+            case 0xCD: return makeInt((uint16_t)readBE(2));
+            case 0xCE: return makeInt((uint32_t)readBE(4));
+            case 0xCF: return makeInt((int64_t)readBE(8));
+            case 0xD0: return makeInt((int8_t)readBE(1));
+            case 0xD1: return makeInt((int16_t)readBE(2));
+            case 0xD2: return makeInt((int32_t)readBE(4));
+            case 0xD9: return readString(readBE(1));
+            case 0xDA: return readString(readBE(2));
+            case 0xDC: return readArray(readBE(2));
+            case 0xDD: return readArray(readBE(4));
+            case 0xDE: return readMap(readBE(2));
+            case 0xDF: return readMap(readBE(4));
+        }
+        error = true;
+        return v;
+    }
+};
+
+// 批量消息中的一个样本，已换算回浮点单位
+struct DecodedSample {
+    uint32_t seq;
+    uint32_t ms;
+    float voltage;   // V
+    float current;   // mA
+    float power;     // mW
+    bool hasExtremes;   // 按变化上报时附带自上次上报以来的极值
+    float minVoltage, maxVoltage;
+    float minCurrent, maxCurrent;
+    float minPower, maxPower;
+};
+
+// 解析 encodeBatchMsgPack 的输出
+inline bool decodeBatch(const uint8_t* data, size_t size, std::vector<DecodedSample>& out) {
+    MsgPackValue root;
+    MsgPackDecoder decoder(data, size);
+    if (!decoder.decode(root) || root.type != MsgPackValue::MAP) return false;
+    const MsgPackValue* seq0 = root.get("seq0");
+    const MsgPackValue* ms0 = root.get("ms0");
+    const MsgPackValue* samples = root.get("samples");
+    if (!seq0 || !ms0 || !samples || samples->type != MsgPackValue::ARRAY) return false;
+    for (size_t n = 0; n < samples->items.size(); n++) {
+        const MsgPackValue& item = samples->items[n];
+        if (item.type != MsgPackValue::ARRAY) return false;
+        const std::vector<MsgPackValue>& f = item.items;
+        DecodedSample s = DecodedSample();
+        if (f.size() == 4) {
+            // 连续样本：[ms-ms0, mv, ma10, mw]
+            s.seq = (uint32_t)(seq0->i + n);
+            s.ms = (uint32_t)(ms0->i + f[0].i);
+            s.voltage = f[1].i / 1000.0f;
+            s.current = f[2].i / 10.0f;
+            s.power = (float)f[3].i;
+        } else if (f.size() == 11) {
+            // 按变化上报：[seq-seq0, ms-ms0, mv, ma10, mw, 极值...]
+            s.seq = (uint32_t)(seq0->i + f[0].i);
+            s.ms = (uint32_t)(ms0->i + f[1].i);
+            s.voltage = f[2].i / 1000.0f;
+            s.current = f[3].i / 10.0f;
+            s.power = (float)f[4].i;
+            s.hasExtremes = true;
+            s.minVoltage = f[5].i / 1000.0f;
+            s.maxVoltage = f[6].i / 1000.0f;
+            s.minCurrent = f[7].i / 10.0f;
+            s.maxCurrent = f[8].i / 10.0f;
+            s.minPower = (float)f[9].i;
+            s.maxPower = (float)f[10].i;
+        } else {
+            return false;
+        }
+        out.push_back(s);
+    }
+    return true;
+}
+
+#endif // TEST_MSGPACK_DECODER_H
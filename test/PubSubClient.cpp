@@ -0,0 +1,123 @@
+#include <algorithm>
+#include "PubSubClient.h"
+
+bool SimBroker::up = true;
+uint32_t SimBroker::connectDelayMs = 0;
+std::vector<SimBroker::Message> SimBroker::messages;
+std::vector<PubSubClient*> SimBroker::clients;
+
+void SimBroker::reset() {
+    up = true;
+    connectDelayMs = 0;
+    messages.clear();
+}
+
+size_t SimBroker::count(const char* topic) {
+    size_t n = 0;
+    for (size_t i = 0; i < messages.size(); i++) {
+        if (messages[i].topic == topic) n++;
+    }
+    return n;
+}
+
+const SimBroker::Message* SimBroker::last(const char* topic) {
+    for (size_t i = messages.size(); i > 0; i--) {
+        if (messages[i - 1].topic == topic) return &messages[i - 1];
+    }
+    return nullptr;
+}
+
+void SimBroker::attach(PubSubClient* client) {
+    if (std::find(clients.begin(), clients.end(), client) == clients.end()) {
+        clients.push_back(client);
+    }
+}
+
+void SimBroker::detach(PubSubClient* client) {
+    clients.erase(std::remove(clients.begin(), clients.end(), client), clients.end());
+}
+
+void SimBroker::route(const char* topic, const uint8_t* payload, size_t len) {
+    Message m;
+    m.topic = topic;
+    m.payload.assign(payload, payload + len);
+    messages.push_back(m);
+    for (size_t i = 0; i < clients.size(); i++) {
+        if (clients[i]->matches(topic)) clients[i]->deliver(topic, payload, len);
+    }
+}
+
+bool PubSubClient::connect(const char* /*id*/, const char* /*user*/, const char* /*pass*/) {
+    delay(SimBroker::connectDelayMs);
+    if (!WiFi.connected || !SimBroker::up) {
+        isConnected = false;
+        lastState = MQTT_CONNECT_FAILED;
+        return false;
+    }
+    isConnected = true;
+    lastState = MQTT_CONNECTED;
+    subscriptions.clear();
+    SimBroker::attach(this);
+    return true;
+}
+
+void PubSubClient::disconnect() {
+    isConnected = false;
+    lastState = MQTT_DISCONNECTED;
+    SimBroker::detach(this);
+}
+
+bool PubSubClient::connected() {
+    if (isConnected && (!SimBroker::up || !WiFi.connected)) {
+        isConnected = false;
+        lastState = MQTT_CONNECTION_LOST;
+        SimBroker::detach(this);
+    }
+    return isConnected;
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int len) {
+    if (!connected()) return false;
+    // 与库一致：固定头、主题长度和主题一起放入发送缓冲，超出时发布失败
+    if (len + strlen(topic) + 7 > bufferSize) return false;
+    SimBroker::route(topic, payload, len);
+    return true;
+}
+
+bool PubSubClient::subscribe(const char* topic) {
+    if (!connected()) return false;
+    subscriptions.push_back(topic);
+    return true;
+}
+
+bool PubSubClient::matches(const char* topic) const {
+    for (size_t i = 0; i < subscriptions.size(); i++) {
+        const std::string& s = subscriptions[i];
+        if (s == topic) return true;
+        // 只支持末尾的 # 通配
+        if (!s.empty() && s[s.size() - 1] == '#' && strncmp(s.c_str(), topic, s.size() - 1) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PubSubClient::deliver(const char* topic, const uint8_t* payload, size_t len) {
+    SimBroker::Message m;
+    m.topic = topic;
+    m.payload.assign(payload, payload + len);
+    inbox.push_back(m);
+}
+
+bool PubSubClient::loop() {
+    if (!connected()) return false;
+    std::vector<SimBroker::Message> pending;
+    pending.swap(inbox);
+    for (size_t i = 0; i < pending.size(); i++) {
+        if (!callback) continue;
+        std::string topic = pending[i].topic;
+        pending[i].payload.push_back(0);
+        callback(&topic[0], pending[i].payload.data(), pending[i].payload.size() - 1);
+    }
+    return connected();
+}
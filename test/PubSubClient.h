@@ -0,0 +1,87 @@
+#ifndef TEST_PUBSUBCLIENT_H
+#define TEST_PUBSUBCLIENT_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+#include "ESP8266WiFi.h"
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+class PubSubClient;
+
+// 进程内的回环代理：记录全部发布的消息，并投递给订阅了该主题的客户端
+// （在其 loop() 中回调）。up 为false时拒绝连接并断开已有连接
+class SimBroker {
+public:
+    struct Message {
+        std::string topic;
+        std::vector<uint8_t> payload;
+    };
+
+    static bool up;
+    static uint32_t connectDelayMs;     // 一次连接尝试消耗的模拟时间
+    static std::vector<Message> messages;
+
+    static void reset();
+    static size_t count(const char* topic);
+    static const Message* last(const char* topic);
+
+    static void attach(PubSubClient* client);
+    static void detach(PubSubClient* client);
+    static void route(const char* topic, const uint8_t* payload, size_t len);
+
+private:
+    static std::vector<PubSubClient*> clients;
+};
+
+class PubSubClient {
+public:
+    typedef std::function<void(char*, uint8_t*, unsigned int)> Callback;
+
+    explicit PubSubClient(WiFiClient& /*client*/)
+        : bufferSize(256), socketTimeout(15), port(0), isConnected(false), lastState(MQTT_DISCONNECTED) {}
+    ~PubSubClient() { SimBroker::detach(this); }
+
+    PubSubClient& setServer(IPAddress ip, uint16_t p) { server = ip; port = p; return *this; }
+    PubSubClient& setServer(const char* /*host*/, uint16_t p) { port = p; return *this; }
+    PubSubClient& setCallback(Callback cb) { callback = cb; return *this; }
+    bool setBufferSize(uint16_t size) { bufferSize = size; return true; }
+    uint16_t getBufferSize() const { return bufferSize; }
+    PubSubClient& setSocketTimeout(uint16_t seconds) { socketTimeout = seconds; return *this; }
+
+    bool connect(const char* id) { return connect(id, nullptr, nullptr); }
+    bool connect(const char* id, const char* user, const char* pass);
+    void disconnect();
+    bool connected();
+    int state() const { return lastState; }
+
+    bool publish(const char* topic, const uint8_t* payload, unsigned int len);
+    bool publish(const char* topic, const char* payload) {
+        return publish(topic, (const uint8_t*)payload, strlen(payload));
+    }
+    bool subscribe(const char* topic);
+    bool loop();
+
+    // 代理投递，保存到下次 loop()
+    void deliver(const char* topic, const uint8_t* payload, size_t len);
+    bool matches(const char* topic) const;
+
+private:
+    uint16_t bufferSize;
+    uint16_t socketTimeout;
+    IPAddress server;
+    uint16_t port;
+    bool isConnected;
+    int lastState;
+    Callback callback;
+    std::vector<std::string> subscriptions;
+    std::vector<SimBroker::Message> inbox;
+};
+
+#endif // TEST_PUBSUBCLIENT_H
@@ -0,0 +1,43 @@
+#ifndef TEST_TESTUTIL_H
+#define TEST_TESTUTIL_H
+
+// 各测试程序共用的检查与汇总。每个测试程序只有一个源文件，这里的定义直接放在头文件中。
+// ctest 按退出码判定结果，pdutest 另按输出中的 "Test failed" 判定
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+static int failures = 0;
+
+static void check(bool condition, const char* message) {
+    if (!condition) {
+        printf("Test failed: %s\n", message);
+        failures++;
+    }
+}
+
+// 打印汇总并返回进程退出码：全部通过时输出 "All <what> passed"
+static int report(const char* what) {
+    if (failures == 0) {
+        printf("All %s passed\n", what);
+        return 0;
+    }
+    return 1;
+}
+
+#ifdef TEST_COUNT_ALLOCATIONS
+// 替换全局 operator new，统计堆分配次数；在包含本文件前定义 TEST_COUNT_ALLOCATIONS 启用
+static unsigned long allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+#endif
+
+#endif // TEST_TESTUTIL_H
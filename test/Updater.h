@@ -0,0 +1,18 @@
+#ifndef TEST_UPDATER_H
+#define TEST_UPDATER_H
+
+#include "Arduino.h"
+
+// 固件升级模拟：只统计写入的字节数，不写闪存
+class UpdaterClass {
+public:
+    bool begin(size_t /*maxSize*/) { size = 0; return true; }
+    size_t write(uint8_t* /*data*/, size_t len) { size += len; return len; }
+    bool end(bool /*evenIfRemaining*/ = false) { return size > 0; }
+
+    size_t size = 0;
+};
+
+extern UpdaterClass Update;
+
+#endif // TEST_UPDATER_H
@@ -0,0 +1,42 @@
+#ifndef TEST_WEBRIG_H
+#define TEST_WEBRIG_H
+
+// 真实 WebServer 及其依赖的子系统，按 main.cpp 的方式组装在模拟环境中，
+// 构造后即可向 80 端口的模拟服务器发请求
+#include "EasyLed.h"
+#include "ESP8266WebServer.h"
+#include "PubSubClient.h"
+#include "WebServer.h"
+
+struct WebRig {
+    EasyLed led;
+    EspSmartWifi wifi;
+    Display display;
+    VoltageCtl voltageCtl;
+    WiFiClient client;
+    PubSubClient mqtt;
+    MqttConnection mqttConnection;
+    PowerTelemetry telemetry;
+    Scheduler scheduler;
+    TraceRecorder traceRecorder;
+    WebServer web;
+    ESP8266WebServer* server;
+
+    WebRig(PowerMonitor& monitor, I2cBus& bus, I2cPort& port)
+        : led(2, EasyLed::ActiveLevel::Low), wifi(led), display(wifi, monitor), mqtt(client),
+          mqttConnection(mqtt, client), telemetry(monitor, mqtt),
+          web(wifi, led, display, voltageCtl, monitor,
+              WebServerContext{mqttConnection, telemetry, scheduler, bus, port, traceRecorder}) {
+        web.begin();
+        server = ESP8266WebServer::listening(80);
+    }
+    ~WebRig() { web.stop(); }
+
+    ESP8266WebServer::Response request(HTTPMethod method, const char* uri, const char* accept = nullptr) {
+        std::vector<std::pair<std::string, std::string> > headers;
+        if (accept != nullptr) headers.push_back(std::make_pair(std::string("Accept"), std::string(accept)));
+        return server->request(method, uri, headers);
+    }
+};
+
+#endif // TEST_WEBRIG_H
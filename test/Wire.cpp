@@ -0,0 +1,85 @@
+#include "Wire.h"
+
+TwoWire Wire;
+
+static SimI2cDevice* devices[128];
+
+void TwoWire::attach(uint8_t address, SimI2cDevice* device) {
+    devices[address & 0x7F] = device;
+}
+
+void TwoWire::detach(uint8_t address) {
+    devices[address & 0x7F] = nullptr;
+}
+
+// 每字节9个时钟（含ACK），另加地址字节
+void TwoWire::spend(size_t bytes) {
+    SimClock::advance((uint64_t)(bytes + 1) * 9 * 1000000 / clock);
+}
+
+uint8_t TwoWire::endTransmission(bool /*sendStop*/) {
+    transactions++;
+    spend(txLen);
+    SimI2cDevice* device = devices[txAddress & 0x7F];
+    if (device == nullptr) return 2;
+    return device->write(txBuffer, txLen) ? 0 : 3;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t len, bool /*sendStop*/) {
+    transactions++;
+    rxLen = 0;
+    rxPos = 0;
+    if (len > sizeof(rxBuffer)) len = sizeof(rxBuffer);
+    SimI2cDevice* device = devices[address & 0x7F];
+    if (device == nullptr) {
+        spend(0);
+        return 0;
+    }
+    spend(len);
+    if (!device->read(rxBuffer, len)) return 0;
+    rxLen = len;
+    return len;
+}
+
+bool SimIna219::write(const uint8_t* data, size_t len) {
+    if (failCount > 0) {
+        failCount--;
+        return false;
+    }
+    if (len == 0) return true;
+    pointer = data[0] < 6 ? data[0] : 0;
+    if (len >= 3) {
+        uint16_t value = ((uint16_t)data[1] << 8) | data[2];
+        if (pointer == 0) {
+            registers[0] = value;
+        } else if (pointer == 5) {
+            registers[5] = value & 0xFFFE;
+            calibrationWrites++;
+        }
+        update();
+    }
+    return true;
+}
+
+bool SimIna219::read(uint8_t* data, size_t len) {
+    if (failCount > 0) {
+        failCount--;
+        return false;
+    }
+    reads++;
+    uint16_t value = registers[pointer];
+    for (size_t i = 0; i < len; i++) {
+        data[i] = i == 0 ? value >> 8 : (i == 1 ? value & 0xFF : 0);
+    }
+    return true;
+}
+
+// 数据手册的换算：电流 = 分流 × 校准 / 4096，功率 = 电流 × 总线 / 5000
+void SimIna219::update() {
+    registers[1] = (uint16_t)shunt;
+    registers[2] = (uint16_t)((bus << 3) | 0x02);
+    int32_t current = (int32_t)shunt * registers[5] / 4096;
+    registers[4] = (uint16_t)(int16_t)current;
+    int32_t power = (current < 0 ? -current : current) * bus / 5000;
+    registers[3] = (uint16_t)power;
+}
@@ -0,0 +1,109 @@
+#ifndef TEST_WIRE_H
+#define TEST_WIRE_H
+
+#include "Arduino.h"
+
+// 挂在模拟总线上的从机。write() 收到一次写事务的全部字节，read() 填充一次读事务
+class SimI2cDevice {
+public:
+    virtual ~SimI2cDevice() {}
+    virtual bool write(const uint8_t* data, size_t len) = 0;
+    virtual bool read(uint8_t* data, size_t len) = 0;
+};
+
+// 模拟的 Wire：按地址把事务转发给登记的从机，并按当前时钟推进模拟时间，
+// 与 ESP8266 上软件 I2C 占用 CPU 的时间一致
+class TwoWire {
+public:
+    TwoWire() : clock(100000), txAddress(0), txLen(0), rxLen(0), rxPos(0), transactions(0) {}
+
+    void begin() {}
+    void begin(int /*sda*/, int /*scl*/) {}
+    void setClock(uint32_t hz) { clock = hz; }
+    uint32_t getClock() const { return clock; }
+
+    void beginTransmission(uint8_t address) {
+        txAddress = address;
+        txLen = 0;
+    }
+    size_t write(uint8_t b) {
+        if (txLen >= sizeof(txBuffer)) return 0;
+        txBuffer[txLen++] = b;
+        return 1;
+    }
+    size_t write(const uint8_t* data, size_t len) {
+        size_t n = 0;
+        while (n < len && write(data[n])) n++;
+        return n;
+    }
+    // 返回值与 Arduino 一致：0 成功，2 地址无应答，3 数据无应答
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t len, bool sendStop = true);
+    int available() { return rxLen - rxPos; }
+    int read() { return rxPos < rxLen ? rxBuffer[rxPos++] : -1; }
+
+    // 模拟设备登记，address 只能挂一个设备
+    static void attach(uint8_t address, SimI2cDevice* device);
+    static void detach(uint8_t address);
+    uint32_t getTransactions() const { return transactions; }
+
+private:
+    uint32_t clock;
+    uint8_t txAddress;
+    uint8_t txBuffer[128];
+    size_t txLen;
+    uint8_t rxBuffer[128];
+    size_t rxLen;
+    size_t rxPos;
+    uint32_t transactions;
+
+    void spend(size_t bytes);
+};
+
+extern TwoWire Wire;
+
+// INA219 模型：寄存器按芯片行为计算。测试设置分流电压和总线电压，
+// 电流和功率寄存器由校准寄存器换算，校准为0（上电或复位后）时读数为0
+class SimIna219 : public SimI2cDevice {
+public:
+    SimIna219() : shunt(0), bus(0), failCount(0), reads(0), calibrationWrites(0) { reset(); }
+
+    // 模拟掉电复位：配置恢复默认，校准清零
+    void reset() {
+        pointer = 0;
+        registers[0] = 0x399F;
+        for (int i = 1; i < 6; i++) registers[i] = 0;
+        update();
+    }
+
+    void setShuntVoltage_mV(float mv) {
+        shunt = (int16_t)(mv * 100);    // 每位10μV
+        update();
+    }
+    void setBusVoltage_V(float v) {
+        bus = (uint16_t)(v * 1000 / 4);  // 每位4mV
+        update();
+    }
+    // 接下来 n 个事务无应答
+    void failNext(int n) { failCount = n; }
+
+    uint16_t getRegister(uint8_t reg) const { return registers[reg]; }
+    uint32_t getReads() const { return reads; }
+    uint32_t getCalibrationWrites() const { return calibrationWrites; }
+
+    bool write(const uint8_t* data, size_t len) override;
+    bool read(uint8_t* data, size_t len) override;
+
+private:
+    uint16_t registers[6];
+    uint8_t pointer;
+    int16_t shunt;
+    uint16_t bus;
+    int failCount;
+    uint32_t reads;
+    uint32_t calibrationWrites;
+
+    void update();
+};
+
+#endif // TEST_WIRE_H
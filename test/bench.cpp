@@ -0,0 +1,140 @@
+// 固件热点的主机微基准：与设备上 /bench 相同的用例（src/BenchSuite），外加只能在主机上
+// 测的完整采样管线和真实 WebServer 的 /power、/power/since、/metrics。CPU 用例用单调时钟计时；
+// 传感器用例用模拟时钟计时，给出按总线时钟推算的传输时间，与设备上实测的量级可比。
+//
+//   bench            表格输出，并检查结果是否合理（ctest 用例）
+//   bench --json out.json   把结果写成 JSON 数组，便于脚本比较两次运行
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+#include "Wire.h"
+#include "PowerMonitor.h"
+#include "BenchSuite.h"
+#include "WebRig.h"
+#include "TestUtil.h"
+
+static uint32_t hostClock() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 模拟时钟按 80MHz 计数，每个周期12.5ns
+static uint32_t simClock() {
+    return ESP.getCycleCount();
+}
+
+static void collect(const BenchResult& result, void* context) {
+    static_cast<std::vector<BenchResult>*>(context)->push_back(result);
+}
+
+static const BenchResult* find(const std::vector<BenchResult>& results, const char* name) {
+    for (size_t i = 0; i < results.size(); i++) {
+        if (strcmp(results[i].name, name) == 0) return &results[i];
+    }
+    return nullptr;
+}
+
+int main(int argc, char** argv) {
+    const char* jsonPath = argc > 2 && strcmp(argv[1], "--json") == 0 ? argv[2] : nullptr;
+    std::vector<BenchResult> results;
+    Bench cpu(hostClock, 1.0f);
+    Bench bus(simClock, 1000.0f / ESP.getCpuFreqMHz());
+
+    SimIna219 ina;
+    ina.setBusVoltage_V(12.0);
+    ina.setShuntVoltage_mV(150);
+    TwoWire::attach(INA219_ADDRESS, &ina);
+    I2cBus i2c;
+    WirePort port(i2c);
+    I2cEngine engine(port);
+    PowerMonitor* monitor = new PowerMonitor();
+    i2c.begin();
+    i2c.setEngine(&engine);
+    monitor->begin(i2c, engine);
+    i2c.restoreClock();
+
+    // 填满历史缓冲
+    for (int i = 0; i < POWER_HISTORY_SIZE; i++) {
+        monitor->update();
+        while (engine.poll()) {}
+        SimClock::advanceMillis(POWER_SAMPLE_INTERVAL_MS);
+    }
+
+    runCodecBenchmarks(cpu, collect, &results);
+    runHistoryBenchmarks(cpu, *monitor, collect, &results);
+    runSensorBenchmarks(bus, port, collect, &results);
+
+    // 一次完整采样：四次寄存器传输（模拟总线）、滑动平均、电能积分、写入历史和快照缓存
+    uint32_t before = monitor->getLatestSeq();
+    results.push_back(cpu.run("monitor.sample", [&]() {
+        SimClock::advanceMillis(POWER_SAMPLE_INTERVAL_MS);
+        monitor->update();
+        while (engine.poll()) {}
+    }, 50));
+    uint32_t sampled = monitor->getLatestSeq() - before;
+
+    // 端到端请求：路由分发、参数与 Accept 判断、真实处理函数的序列化和分块发送
+    size_t powerLength = 0;
+    size_t sinceLength = 0;
+    {
+        WebRig web(*monitor, i2c, port);
+        results.push_back(cpu.run("http.power", [&]() {
+            powerLength = web.request(HTTP_GET, "/power").body.size();
+        }, 100));
+        char uri[32];
+        snprintf(uri, sizeof(uri), "/power/since?seq=%lu", (unsigned long)(monitor->getLatestSeq() - 20));
+        results.push_back(cpu.run("http.power.since20", [&]() {
+            sinceLength = web.request(HTTP_GET, uri).body.size();
+        }, 100));
+        results.push_back(cpu.run("http.metrics", [&]() {
+            web.request(HTTP_GET, "/metrics");
+        }, 20));
+    }
+
+    delete monitor;
+    TwoWire::detach(INA219_ADDRESS);
+
+    char line[256];
+    Bench::formatHeader(line, sizeof(line));
+    printf("%s", line);
+    for (size_t i = 0; i < results.size(); i++) {
+        Bench::formatRow(results[i], line, sizeof(line));
+        printf("%s", line);
+    }
+    printf("(ns per call; ina219.* modeled bus time, others host CPU time)\n");
+
+    if (jsonPath != nullptr) {
+        FILE* f = fopen(jsonPath, "w");
+        if (f == nullptr) {
+            printf("cannot write %s\n", jsonPath);
+            return 1;
+        }
+        fprintf(f, "[");
+        for (size_t i = 0; i < results.size(); i++) {
+            Bench::formatJson(results[i], line, sizeof(line));
+            fprintf(f, "%s%s\n", i == 0 ? "" : ",", line);
+        }
+        fprintf(f, "]\n");
+        fclose(f);
+    }
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        check(r.min >= 0 && r.min <= r.median && r.median <= r.p95 && r.p95 <= r.max, r.name);
+    }
+    const BenchResult* slow = find(results, "ina219.read@100k");
+    const BenchResult* fast = find(results, "ina219.read@400k");
+    check(slow != nullptr && fast != nullptr && slow->median > fast->median * 3,
+          "register read scales with the bus clock");
+    // 3字节地址+寄存器+2字节数据，两个事务各有起始位和应答：100kHz 下约 0.4ms
+    check(slow != nullptr && slow->median > 300000 && slow->median < 600000, "modeled 100kHz read time");
+    check(sampled == 50 * (BENCH_DEFAULT_BATCHES + 1), "monitor.sample stores one sample per call");
+    check(powerLength > 20, "/power returns the snapshot");
+    check(sinceLength > 20 * 20, "/power/since returns 20 samples");
+
+    return report("benchmark checks");
+}
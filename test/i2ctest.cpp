@@ -0,0 +1,170 @@
+// I2C 传输引擎的主机测试：用模拟总线检查执行顺序、每次 poll() 的传输量、
+// 失败重试、回调中串接请求，以及队列满时的处理。
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "../src/I2cEngine.h"
+#include "TestUtil.h"
+
+// 模拟总线：按地址保存16位寄存器，记录每次传输，按 400kHz 累计总线时间
+class MockBus : public I2cPort {
+public:
+    struct Transfer {
+        uint8_t address;
+        uint8_t reg;
+        bool write;
+    };
+
+    std::vector<Transfer> log;
+    uint16_t registers[128][8];
+    int failNext;          // 接下来这么多次传输失败
+    uint32_t busyUs;
+    int retries;
+
+    MockBus() : failNext(0), busyUs(0), retries(0) {
+        memset(registers, 0, sizeof(registers));
+    }
+
+    bool transfer(int /*device*/, uint8_t address, const uint8_t* tx, size_t txLen,
+                  uint8_t* rx, size_t rxLen) override {
+        // 每字节9个时钟，另加地址字节
+        busyUs += (uint32_t)((txLen + rxLen + 1) * 9 * 1000000UL / 400000);
+        Transfer t = {address, tx[0], rxLen == 0};
+        log.push_back(t);
+        if (failNext > 0) {
+            failNext--;
+            return false;
+        }
+        uint8_t reg = tx[0] & 7;
+        if (rxLen == 0) {
+            if (txLen >= 3) registers[address][reg] = ((uint16_t)tx[1] << 8) | tx[2];
+        } else {
+            rx[0] = registers[address][reg] >> 8;
+            rx[1] = registers[address][reg] & 0xFF;
+        }
+        return true;
+    }
+
+    void retried(int /*device*/) override { retries++; }
+};
+
+struct Result {
+    std::vector<uint16_t> values;
+    std::vector<bool> ok;
+    std::vector<uint8_t> attempts;
+};
+
+static void collect(const I2cRequest& request, void* context) {
+    Result* result = static_cast<Result*>(context);
+    result->values.push_back(request.value16());
+    result->ok.push_back(request.ok);
+    result->attempts.push_back(request.attempts);
+}
+
+// 两个设备交错提交，按提交顺序执行，每次 poll() 只执行一个传输
+static void testOrdering() {
+    MockBus bus;
+    I2cEngine engine(bus);
+    Result result;
+    bus.registers[0x40][4] = 0x1234;
+    bus.registers[0x3C][2] = 0xBEEF;
+
+    engine.writeRegister16(0, 0x40, 5, 4096, 0, collect, &result);
+    engine.readRegister16(1, 0x3C, 2, 0, collect, &result);
+    engine.readRegister16(0, 0x40, 4, 0, collect, &result);
+    check(engine.pending() == 3, "three requests queued");
+
+    size_t polls = 0;
+    while (engine.poll()) {
+        polls++;
+        check(bus.log.size() == polls, "one transfer per poll");
+    }
+    check(polls == 3 && engine.pending() == 0, "queue drained in three polls");
+    check(bus.log[0].address == 0x40 && bus.log[0].write, "calibration write first");
+    check(bus.log[1].address == 0x3C && bus.log[1].reg == 2, "display read second");
+    check(bus.log[2].address == 0x40 && bus.log[2].reg == 4, "current read third");
+    check(bus.registers[0x40][5] == 4096, "write reached the register");
+    check(result.values.size() == 3 && result.values[1] == 0xBEEF && result.values[2] == 0x1234,
+          "read values delivered to callbacks");
+    // 400kHz 下寄存器读为4字节时间约90μs，单次 poll() 的总线时间以此为上限
+    check(bus.busyUs <= 3 * 90, "bus time bounded per transfer");
+}
+
+// 失败后留在队首重试，重试期间不执行后面的请求；重试用尽后回调收到失败
+static void testRetries() {
+    MockBus bus;
+    I2cEngine engine(bus);
+    Result result;
+
+    bus.failNext = 2;
+    engine.readRegister16(0, 0x40, 4, 2, collect, &result);
+    engine.readRegister16(0, 0x40, 2, 0, collect, &result);
+    engine.poll();
+    engine.poll();
+    check(result.ok.empty(), "no callback while retrying");
+    check(bus.log.size() == 2 && bus.log[1].reg == 4, "retry stays at the head");
+    engine.poll();
+    check(result.ok.size() == 1 && result.ok[0] && result.attempts[0] == 3, "succeeds on third attempt");
+    check(bus.retries == 2 && engine.getRetried() == 2, "retries counted");
+
+    bus.failNext = 1;
+    engine.poll();
+    check(result.ok.size() == 2 && !result.ok[1], "failure reported when no retries left");
+    check(engine.getFailed() == 1 && engine.getCompleted() == 1, "completion counters");
+}
+
+// 回调中提交下一步，多步读取作为状态机运行
+struct Chain {
+    I2cEngine* engine;
+    int step;
+    uint16_t values[3];
+};
+
+static void chainStep(const I2cRequest& request, void* context) {
+    Chain* chain = static_cast<Chain*>(context);
+    chain->values[chain->step++] = request.value16();
+    if (chain->step < 3) {
+        chain->engine->readRegister16(0, 0x40, 2 + chain->step, 0, chainStep, chain);
+    }
+}
+
+static void testChain() {
+    MockBus bus;
+    I2cEngine engine(bus);
+    bus.registers[0x40][2] = 1;
+    bus.registers[0x40][3] = 2;
+    bus.registers[0x40][4] = 3;
+
+    Chain chain = {&engine, 0, {0, 0, 0}};
+    engine.readRegister16(0, 0x40, 2, 0, chainStep, &chain);
+    // 其他设备的请求插在链的两步之间
+    Result other;
+    engine.readRegister16(1, 0x3C, 0, 0, collect, &other);
+
+    int polls = 0;
+    while (engine.poll()) polls++;
+    check(polls == 4, "chain of three plus one interleaved request");
+    check(chain.step == 3 && chain.values[0] == 1 && chain.values[1] == 2 && chain.values[2] == 3,
+          "chain read registers in order");
+    check(bus.log[1].address == 0x3C, "other device runs between chain steps");
+}
+
+static void testQueueFull() {
+    MockBus bus;
+    I2cEngine engine(bus);
+    for (int i = 0; i < I2C_QUEUE_SIZE; i++) {
+        check(engine.readRegister16(0, 0x40, 0, 0, nullptr, nullptr), "submit while space left");
+    }
+    check(!engine.readRegister16(0, 0x40, 0, 0, nullptr, nullptr), "submit rejected when full");
+    while (engine.poll()) {}
+    check(engine.getCompleted() == I2C_QUEUE_SIZE, "all queued requests completed");
+}
+
+int main() {
+    testOrdering();
+    testRetries();
+    testChain();
+    testQueueFull();
+    return report("I2C engine tests");
+}
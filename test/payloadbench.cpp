@@ -0,0 +1,167 @@
+// 遥测负载对比：MessagePack 定点编码 vs JSON。
+// 输出各批量大小下的字节数与编码耗时，并解码 MessagePack 校验往返精度。
+// 找到 ArduinoJson 时同时对比改造前逐点发布的 ArduinoJson 输出。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include "../src/PowerCodec.h"
+#include "MsgPackDecoder.h"
+
+#ifdef HAVE_ARDUINOJSON
+#include <ArduinoJson.h>
+#endif
+
+static const int ITERATIONS = 20000;
+
+static std::vector<PowerSample> makeSamples(size_t count) {
+    std::vector<PowerSample> samples;
+    for (size_t i = 0; i < count; i++) {
+        PowerSample s;
+        s.seq = 1000 + i;
+        s.ms = 250000 + i * 250;
+        s.voltage = 11.568f + 0.004f * (i % 3);
+        s.current = 1.6f + 0.1f * (i % 7);
+        s.power = 18.5087986f + 2.0f * (i % 5);
+        s.energy = 1234.5f + 0.0013f * i;
+        samples.push_back(s);
+    }
+    return samples;
+}
+
+template <typename F>
+static double timeNs(F encode) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) encode();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS;
+}
+
+static bool checkRoundTrip(const std::vector<PowerSample>& samples, const PowerExtremes* extremes) {
+    uint8_t buffer[2048];
+    size_t len = encodeBatchMsgPack(samples.data(), extremes, samples.size(), 1718000000, 260512,
+                                    buffer, sizeof(buffer));
+    std::vector<DecodedSample> decoded;
+    if (len == 0 || !decodeBatch(buffer, len, decoded) || decoded.size() != samples.size()) {
+        printf("Test failed: MessagePack batch of %u does not decode\n", (unsigned)samples.size());
+        return false;
+    }
+    for (size_t i = 0; i < samples.size(); i++) {
+        const PowerSample& a = samples[i];
+        const DecodedSample& b = decoded[i];
+        if (a.seq != b.seq || a.ms != b.ms || fabs(a.voltage - b.voltage) > 0.0005f ||
+            fabs(a.current - b.current) > 0.05f || fabs(a.power - b.power) > 0.5f) {
+            printf("Test failed: sample %u differs after round trip\n", (unsigned)i);
+            return false;
+        }
+        if (extremes != nullptr && (!b.hasExtremes ||
+            fabs(extremes[i].minVoltage - b.minVoltage) > 0.0005f ||
+            fabs(extremes[i].maxCurrent - b.maxCurrent) > 0.05f ||
+            fabs(extremes[i].maxPower - b.maxPower) > 0.5f)) {
+            printf("Test failed: extremes of sample %u differ after round trip\n", (unsigned)i);
+            return false;
+        }
+    }
+    printf("Test passed: MessagePack round trip (%u samples%s)\n", (unsigned)samples.size(),
+           extremes != nullptr ? ", with extremes" : "");
+    return true;
+}
+
+// 两种编码的累计电能一致：JSON 的 mwh 为三位小数 mWh，MessagePack 的 uwh 为 µWh
+static bool checkEnergy(const std::vector<PowerSample>& samples) {
+    char json[2048];
+    uint8_t packed[2048];
+    size_t jsonLen = encodeBatchJson(samples.data(), nullptr, samples.size(), 1718000000, 260512,
+                                     json, sizeof(json));
+    size_t packedLen = encodeBatchMsgPack(samples.data(), nullptr, samples.size(), 1718000000, 260512,
+                                          packed, sizeof(packed));
+    const char* field = jsonLen > 0 ? strstr(json, "\"mwh\":") : nullptr;
+    MsgPackValue root;
+    MsgPackDecoder decoder(packed, packedLen);
+    const MsgPackValue* uwh = packedLen > 0 && decoder.decode(root) ? root.get("uwh") : nullptr;
+    if (field == nullptr || uwh == nullptr) {
+        printf("Test failed: batch energy missing\n");
+        return false;
+    }
+    double mwh = strtod(field + 6, nullptr);
+    if (fabs(mwh * 1000.0 - (double)uwh->i) > 1.0) {
+        printf("Test failed: energy %.3f mWh in JSON, %lld uWh in MessagePack\n", mwh, (long long)uwh->i);
+        return false;
+    }
+    printf("Test passed: batch energy %.3f mWh in both encodings\n", mwh);
+    return true;
+}
+
+int main() {
+    bool ok = true;
+    printf("%-8s %-26s %10s %12s\n", "samples", "encoding", "bytes", "ns/encode");
+
+    const size_t batches[] = {1, 20, 32};
+    for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); b++) {
+        std::vector<PowerSample> samples = makeSamples(batches[b]);
+        const PowerSample* data = samples.data();
+        size_t count = samples.size();
+
+        char json[2048];
+        uint8_t packed[2048];
+        size_t jsonLen = 0;
+        size_t packedLen = 0;
+        double jsonNs = timeNs([&]() {
+            jsonLen = encodeBatchJson(data, nullptr, count, 1718000000, 260512, json, sizeof(json));
+        });
+        double packedNs = timeNs([&]() {
+            packedLen = encodeBatchMsgPack(data, nullptr, count, 1718000000, 260512, packed, sizeof(packed));
+        });
+
+#ifdef HAVE_ARDUINOJSON
+        // 改造前的格式：每个样本一条 {"channel1":{...}} 消息
+        size_t arduinoLen = 0;
+        double arduinoNs = timeNs([&]() {
+            arduinoLen = 0;
+            for (size_t i = 0; i < count; i++) {
+                StaticJsonDocument<512> doc;
+                JsonObject channel = doc.createNestedObject("channel1");
+                channel["current"] = data[i].current;
+                channel["voltage"] = data[i].voltage;
+                channel["power"] = data[i].power;
+                char buffer[512];
+                arduinoLen += serializeJson(doc, buffer);
+            }
+        });
+        printf("%-8u %-26s %10u %12.0f\n", (unsigned)count, "ArduinoJson (per point)",
+               (unsigned)arduinoLen, arduinoNs);
+#endif
+        printf("%-8u %-26s %10u %12.0f\n", (unsigned)count, "JSON batch", (unsigned)jsonLen, jsonNs);
+        printf("%-8u %-26s %10u %12.0f\n", (unsigned)count, "MessagePack batch", (unsigned)packedLen, packedNs);
+
+        if (jsonLen == 0 || packedLen == 0 || packedLen >= jsonLen) {
+            printf("Test failed: unexpected payload sizes for batch of %u\n", (unsigned)count);
+            ok = false;
+        }
+        ok = checkRoundTrip(samples, nullptr) && ok;
+        ok = checkEnergy(samples) && ok;
+
+        // 按变化上报时，样本序号不连续并附带极值
+        std::vector<PowerExtremes> extremes(count);
+        for (size_t i = 0; i < count; i++) {
+            samples[i].seq += i * 3;
+            extremes[i].minVoltage = data[i].voltage - 0.1f;
+            extremes[i].maxVoltage = data[i].voltage + 0.1f;
+            extremes[i].minCurrent = data[i].current - 1.5f;
+            extremes[i].maxCurrent = data[i].current + 250.3f;
+            extremes[i].minPower = data[i].power - 10;
+            extremes[i].maxPower = data[i].power + 3000;
+        }
+        ok = checkRoundTrip(samples, extremes.data()) && ok;
+    }
+
+    // 超过 32 位 µWh 的累计电能
+    std::vector<PowerSample> samples = makeSamples(2);
+    samples[1].energy = 5000000.5f;
+    ok = checkEnergy(samples) && ok;
+
+    return ok ? 0 : 1;
+}
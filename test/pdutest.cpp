@@ -1,5 +1,11 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <new>
 #include "../src/pdu.h"
+// 统计解码过程中的堆分配
+#define TEST_COUNT_ALLOCATIONS
+#include "TestUtil.h"
 
 void setUp(void) {
     // setup code
@@ -260,6 +266,140 @@ void test_decodeContent_mixed_encoding() {
     }
 }
 
+// 与上面的用例一样逐条打印通过项，失败计入 TestUtil 的计数
+static void expect(bool condition, const char* name) {
+    if (condition) printf("Test passed: %s\n", name);
+    check(condition, name);
+}
+
+void test_decodePdu_gsm7() {
+    // GSM 7位，含扩展表字符 € [ ] { }
+    SmsMessage m;
+    bool ok = PDUHelper::decodePdu("00040D91683108108300F000004201914103502312C8346853066D78F88D0FB441BDD79B14", m);
+    expect(ok && m.sender == "+8613800138000", "GSM7 PDU sender");
+    expect(m.timestamp == "24/10/19,14:30:05+32", "GSM7 PDU timestamp");
+    expect(m.text == "Hi € [x] {ok}", "GSM7 PDU extension table");
+    expect(m.total == 1 && m.sequence == 1, "GSM7 PDU single part");
+}
+
+void test_decodePdu_invalid_timestamp() {
+    // 月份字节 0xF1 不是 BCD：整条 PDU 无效，而不是输出越界的字段
+    SmsMessage m;
+    bool ok = PDUHelper::decodePdu("00040D91683108108300F0000042F1914103502312C8346853066D78F88D0FB441BDD79B14", m);
+    expect(!ok, "non-BCD timestamp rejected");
+}
+
+void test_decodePdu_ucs2_surrogate() {
+    // UCS2：测试 + U+1F600（代理对 D83D DE00）+ ok
+    SmsMessage m;
+    bool ok = PDUHelper::decodePdu("00040D91683108108300F00008420191410350230C6D4B8BD5D83DDE00006F006B", m);
+    expect(ok && m.text == "测试\xF0\x9F\x98\x80ok", "UCS2 PDU surrogate pair");
+    // 孤立的高代理替换为 U+FFFD
+    uint8_t bytes[] = {0xD8, 0x3D, 0x00, 0x41};
+    char text[16];
+    size_t n = PDUHelper::ucs2ToUtf8(bytes, sizeof(bytes), text, sizeof(text));
+    expect(n == 4 && memcmp(text, "\xEF\xBF\xBD" "A", 4) == 0, "lone surrogate replaced");
+}
+
+void test_decodePdu_alphanumeric() {
+    SmsMessage m;
+    bool ok = PDUHelper::decodePdu("00040BD0CDBC30EC5E0300004201914103504809C337B90C8AC96634", m);
+    expect(ok && m.sender == "MyBank" && m.text == "Code 1234", "alphanumeric sender");
+    expect(m.timestamp == "24/10/19,14:30:05-04", "negative time zone");
+}
+
+void test_decodePdu_8bit() {
+    SmsMessage m;
+    bool ok = PDUHelper::decodePdu("00040D91683108108300F000044201914103502304436166E9", m);
+    expect(ok && m.text == "Café", "8-bit data as Latin-1");
+}
+
+void test_decodePdu_invalid() {
+    SmsMessage m;
+    expect(!PDUHelper::decodePdu("00040D9168310810", m), "truncated PDU rejected");
+    expect(!PDUHelper::decodePdu("0001000B911346610089F60000", m), "SMS-SUBMIT rejected");
+}
+
+void test_multipart() {
+    SmsAssembler assembler;
+    SmsMessage part, complete;
+    // 8位参考号的 GSM7 长短信，两段
+    PDUHelper::decodePdu("004405810180F6000042019141035023110500032A0201A061391DF476975920", part);
+    expect(part.reference == 0x2A && part.total == 2 && part.sequence == 1 && part.sender == "10086",
+           "concatenation header parsed");
+    bool done = assembler.add(part, complete);
+    expect(!done && assembler.pending() == 1, "first part held");
+    PDUHelper::decodePdu("004405810180F6000042019141036023100500032A0202E061391D44BFBF5D", part);
+    done = assembler.add(part, complete);
+    expect(done && complete.text == "Part one, part two.", "GSM7 parts joined");
+    expect(complete.timestamp == "24/10/19,14:30:05+32", "first part timestamp kept");
+
+    // 16位参考号的 UCS2 长短信，分段乱序到达
+    PDUHelper::decodePdu("00440D91683108108300F00008420191410350230D060804123402027B2C4E8C6BB5", part);
+    done = assembler.add(part, complete);
+    expect(!done && part.reference == 0x1234, "16-bit reference parsed");
+    PDUHelper::decodePdu("00440D91683108108300F00008420191410350230D060804123402017B2C4E006BB5", part);
+    done = assembler.add(part, complete);
+    expect(done && complete.text == "第一段第二段", "out-of-order parts joined by sequence");
+    expect(assembler.pending() == 0, "slots released");
+}
+
+// 重构前的写法：逐字符 String += 作为基准
+static String naiveDecodeUcs2(const String& hex) {
+    String result = "";
+    for (int i = 0; i + 3 < hex.length(); i += 4) {
+        char buf[5] = {hex.charAt(i), hex.charAt(i + 1), hex.charAt(i + 2), hex.charAt(i + 3), 0};
+        uint16_t u = strtol(buf, nullptr, 16);
+        if (u < 0x80) {
+            result += (char)u;
+        } else if (u < 0x800) {
+            result += (char)(0xC0 | (u >> 6));
+            result += (char)(0x80 | (u & 0x3F));
+        } else {
+            result += (char)(0xE0 | (u >> 12));
+            result += (char)(0x80 | ((u >> 6) & 0x3F));
+            result += (char)(0x80 | (u & 0x3F));
+        }
+    }
+    return result;
+}
+
+void test_benchmark() {
+    // 一条70字的UCS2短信
+    String hex = "";
+    for (int i = 0; i < 35; i++) hex += "4F60597D";
+    const int rounds = 20000;
+
+    unsigned long before = allocations;
+    auto t0 = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    for (int i = 0; i < rounds; i++) bytes += PDUHelper::decodeHexToString(hex).length();
+    auto t1 = std::chrono::steady_clock::now();
+    unsigned long tableAllocs = allocations - before;
+
+    before = allocations;
+    for (int i = 0; i < rounds; i++) bytes += naiveDecodeUcs2(hex).length();
+    auto t2 = std::chrono::steady_clock::now();
+    unsigned long naiveAllocs = allocations - before;
+
+    double tableUs = std::chrono::duration<double, std::micro>(t1 - t0).count() / rounds;
+    double naiveUs = std::chrono::duration<double, std::micro>(t2 - t1).count() / rounds;
+    printf("Benchmark: 70-char UCS2 message, table decoder %.2f us (%.1f allocs), "
+           "per-char += %.2f us (%.1f allocs)\n",
+           tableUs, (double)tableAllocs / rounds, naiveUs, (double)naiveAllocs / rounds);
+
+    // GSM7 PDU 全流程
+    const char* pdu = "00040D91683108108300F000004201914103502312C8346853066D78F88D0FB441BDD79B14";
+    SmsMessage m;
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) PDUHelper::decodePdu(pdu, strlen(pdu), m);
+    t1 = std::chrono::steady_clock::now();
+    printf("Benchmark: GSM7 PDU decode %.2f us\n",
+           std::chrono::duration<double, std::micro>(t1 - t0).count() / rounds);
+    // 模拟的 String 为空串也分配一次，另加预留的一次
+    expect(bytes > 0 && tableAllocs <= 2UL * rounds, "decoder allocates once per message");
+}
+
 int main() {
     printf("Running PDU decode tests...\n\n");
     
@@ -270,7 +410,27 @@ int main() {
     test_decodeContent_empty();
     test_decodeContent_special();
     test_decodeContent_mixed_encoding();
+
+    test_decodeHexContent_chinese();
+    test_decodeHexContent_ascii();
+    test_decodeHexContent_ascii_direct();
+    test_decodeHexContent_ascii_raw();
+    test_decodeHexContent_empty();
+    test_decodeHexContent_invalid();
+    test_decodeHexContent_mixed();
+    test_decodeHexContent_special();
+    test_decodeHexContent_long();
+    test_decodeHexContent_odd_length();
+
+    test_decodePdu_gsm7();
+    test_decodePdu_invalid_timestamp();
+    test_decodePdu_ucs2_surrogate();
+    test_decodePdu_alphanumeric();
+    test_decodePdu_8bit();
+    test_decodePdu_invalid();
+    test_multipart();
+    test_benchmark();
     
-    printf("\nAll tests completed.\n");
-    return 0;
+    printf("\n");
+    return report("PDU tests");
 } 
\ No newline at end of file
@@ -0,0 +1,281 @@
+// 传感器跟踪重放：把设备上录制的寄存器跟踪（/trace/data）按原时序送入仿真构建中的
+// PowerMonitor 管线，输出样本序列，并报告每个样本的主机CPU时间和堆分配次数。
+//
+//   tracereplay trace.bin [--csv out.csv]
+//
+// 不带参数时合成一段阶跃负载跟踪并检查重放结果，作为 ctest 用例运行。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+#include "Wire.h"
+#include "FS.h"
+#include "PowerMonitor.h"
+#include "SensorTrace.h"
+// 统计重放期间的堆分配
+#define TEST_COUNT_ALLOCATIONS
+#include "TestUtil.h"
+
+// 按跟踪应答的 INA219：读取寄存器时返回该寄存器在当前模拟时刻之前最近的一条记录，
+// 记录为失败时应答一次 NACK。写入（配置、校准）一律接受
+class TraceDevice : public SimI2cDevice {
+public:
+    TraceDevice(const std::vector<TraceRecord>& records, uint8_t address)
+        : pointer(0), nacks(0) {
+        for (size_t i = 0; i < records.size(); i++) {
+            if (records[i].address == address && records[i].registerNumber() < 8) {
+                byRegister[records[i].registerNumber()].push_back(records[i]);
+            }
+        }
+        for (int r = 0; r < 8; r++) cursor[r] = 0;
+    }
+
+    bool write(const uint8_t* data, size_t len) override {
+        if (len > 0) pointer = data[0] & 7;
+        return true;
+    }
+
+    bool read(uint8_t* data, size_t len) override {
+        std::vector<TraceRecord>& list = byRegister[pointer];
+        size_t& c = cursor[pointer];
+        uint32_t now = millis();
+        // 跳到不晚于当前时刻的最后一条记录
+        while (c + 1 < list.size() && list[c + 1].ms <= now) c++;
+        if (list.empty()) return false;
+        TraceRecord& r = list[c];
+        if (r.failed() && r.ms <= now) {
+            // 失败只注入一次，之后按下一条成功的记录应答
+            r.reg &= ~TRACE_REG_FAILED;
+            r.value = c > 0 ? list[c - 1].value : 0;
+            nacks++;
+            return false;
+        }
+        for (size_t i = 0; i < len; i++) data[i] = i == 0 ? r.value >> 8 : r.value & 0xFF;
+        return true;
+    }
+
+    uint32_t getNacks() const { return nacks; }
+
+private:
+    std::vector<TraceRecord> byRegister[8];
+    size_t cursor[8];
+    uint8_t pointer;
+    uint32_t nacks;
+};
+
+static bool loadTrace(const char* path, std::vector<TraceRecord>& records) {
+    FILE* f = fopen(path, "rb");
+    if (f == nullptr) return false;
+    uint8_t header[TRACE_HEADER_SIZE];
+    bool ok = fread(header, 1, sizeof(header), f) == sizeof(header) && decodeTraceHeader(header);
+    uint8_t buf[TRACE_RECORD_SIZE];
+    while (ok && fread(buf, 1, sizeof(buf), f) == sizeof(buf)) {
+        TraceRecord r;
+        decodeTraceRecord(buf, r);
+        records.push_back(r);
+    }
+    fclose(f);
+    return ok;
+}
+
+static bool saveTrace(const char* path, const std::vector<TraceRecord>& records) {
+    FILE* f = fopen(path, "wb");
+    if (f == nullptr) return false;
+    uint8_t header[TRACE_HEADER_SIZE];
+    encodeTraceHeader(header);
+    fwrite(header, 1, sizeof(header), f);
+    for (size_t i = 0; i < records.size(); i++) {
+        uint8_t buf[TRACE_RECORD_SIZE];
+        encodeTraceRecord(records[i], buf);
+        fwrite(buf, 1, sizeof(buf), f);
+    }
+    fclose(f);
+    return true;
+}
+
+struct ReplayResult {
+    std::vector<PowerSample> samples;
+    double cpuUs;               // 采样任务和 I2C 任务的主机CPU时间
+    unsigned long allocations;
+    uint32_t nacks;
+    uint32_t failedSamples;
+    uint32_t reinits;
+};
+
+static ReplayResult replay(const std::vector<TraceRecord>& records) {
+    ReplayResult result;
+    result.cpuUs = 0;
+    TraceDevice device(records, INA219_ADDRESS);
+    TwoWire::attach(INA219_ADDRESS, &device);
+    // 模拟时钟对齐到跟踪的起点，样本的 ms 与录制时可比
+    SimClock::now = (uint64_t)records.front().ms * 1000;
+
+    I2cBus bus;
+    WirePort port(bus);
+    I2cEngine engine(port);
+    PowerMonitor* monitor = new PowerMonitor();
+    bus.begin();
+    bus.setEngine(&engine);
+    monitor->begin(bus, engine);
+    bus.restoreClock();
+
+    uint32_t lastSeq = 0;
+    uint32_t end = records.back().ms + POWER_SAMPLE_INTERVAL_MS;
+    // 结果序列预先分配，重放期间的分配只来自管线本身
+    result.samples.reserve((end - records.front().ms) / POWER_SAMPLE_INTERVAL_MS + 8);
+    unsigned long allocationsBefore = allocations;
+    while (millis() < end) {
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        monitor->update();
+        while (engine.poll()) {}
+        result.cpuUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+        PowerSample s;
+        if (monitor->getLatest(s) && s.seq != lastSeq) {
+            lastSeq = s.seq;
+            result.samples.push_back(s);
+        }
+        SimClock::advanceMillis(1);
+    }
+    result.allocations = allocations - allocationsBefore;
+    result.nacks = device.getNacks();
+    result.failedSamples = monitor->getFailedSamples();
+    result.reinits = monitor->getReinits();
+    delete monitor;
+    TwoWire::detach(INA219_ADDRESS);
+    return result;
+}
+
+static void report(const std::vector<TraceRecord>& records, const ReplayResult& r) {
+    size_t n = r.samples.size();
+    printf("records %lu, span %lu ms\n", (unsigned long)records.size(),
+           (unsigned long)(records.back().ms - records.front().ms));
+    printf("samples %lu, failed %lu, reinits %lu, injected nacks %lu\n", (unsigned long)n,
+           (unsigned long)r.failedSamples, (unsigned long)r.reinits, (unsigned long)r.nacks);
+    printf("cpu %.2f us/sample (host), allocations %lu\n", n ? r.cpuUs / n : 0.0, r.allocations);
+}
+
+static void writeCsv(const char* path, const ReplayResult& r) {
+    FILE* f = fopen(path, "w");
+    if (f == nullptr) {
+        printf("cannot write %s\n", path);
+        return;
+    }
+    fprintf(f, "seq,ms,voltage,current,power,energy,flags\n");
+    for (size_t i = 0; i < r.samples.size(); i++) {
+        const PowerSample& s = r.samples[i];
+        fprintf(f, "%lu,%lu,%.3f,%.1f,%.0f,%.4f,%u\n", (unsigned long)s.seq, (unsigned long)s.ms,
+                s.voltage, s.current, s.power, s.energy, (unsigned)s.flags);
+    }
+    fclose(f);
+}
+
+// 合成跟踪：12V，前10秒0.5A，之后1.5A，第12秒有一次电流读取失败
+static std::vector<TraceRecord> syntheticTrace() {
+    std::vector<TraceRecord> records;
+    for (uint32_t ms = 1000; ms < 21000; ms += POWER_SAMPLE_INTERVAL_MS) {
+        uint16_t current = ms < 11000 ? 5000 : 15000;     // 每位0.1mA
+        uint16_t bus = (3000 << 3) | 2;                    // 12V，每位4mV
+        uint16_t power = current * 3000 / 5000;            // 每位2mW
+        TraceRecord r;
+        r.ms = ms;
+        r.address = INA219_ADDRESS;
+        r.reg = INA219_REG_CURRENT | (ms == 13000 ? TRACE_REG_FAILED : 0);
+        r.value = current;
+        records.push_back(r);
+        r.reg = INA219_REG_BUSVOLTAGE;
+        r.value = bus;
+        records.push_back(r);
+        r.reg = INA219_REG_POWER;
+        r.value = power;
+        records.push_back(r);
+    }
+    return records;
+}
+
+static int selfTest() {
+    std::vector<TraceRecord> records = syntheticTrace();
+    const char* path = "tracereplay-synthetic.bin";
+    check(saveTrace(path, records), "write synthetic trace");
+    std::vector<TraceRecord> loaded;
+    check(loadTrace(path, loaded) && loaded.size() == records.size(), "trace file round trip");
+    remove(path);
+
+    ReplayResult r = replay(loaded);
+    report(loaded, r);
+    check(r.samples.size() >= 78 && r.samples.size() <= 81, "one output sample per recorded sample");
+    const PowerSample& last = r.samples.back();
+    check(last.voltage > 11.99 && last.voltage < 12.01, "bus voltage replayed");
+    check(last.current > 1499.5 && last.current < 1500.5, "moving average settles on the step");
+    check(last.power > 17990 && last.power < 18010, "power replayed");
+    check(r.nacks == 1, "recorded read failure injected");
+    check(r.allocations == 0, "sample pipeline does not allocate");
+
+    bool retried = false;
+    for (size_t i = 0; i < r.samples.size(); i++) {
+        if (r.samples[i].flags & SAMPLE_FLAG_RETRIED) retried = true;
+    }
+    check(retried, "failed read shows up as a retried sample");
+
+    // 设备侧录制：模拟 INA219 → PowerMonitor → TraceRecorder → SPIFFS，再重放录到的文件
+    SimIna219 ina;
+    ina.setBusVoltage_V(5.0);
+    ina.setShuntVoltage_mV(80);
+    TwoWire::attach(INA219_ADDRESS, &ina);
+    {
+        I2cBus bus;
+        WirePort port(bus);
+        I2cEngine engine(port);
+        PowerMonitor* monitor = new PowerMonitor();
+        TraceRecorder recorder;
+        bus.begin();
+        bus.setEngine(&engine);
+        monitor->begin(bus, engine);
+        monitor->setTrace(&recorder);
+        uint32_t opens = SPIFFS.opens;
+        check(recorder.start(3000), "recording starts");
+        for (int i = 0; i < 4000; i++) {
+            monitor->update();
+            while (engine.poll()) {}
+            if (i % 100 == 0) recorder.loop();
+            SimClock::advanceMillis(1);
+        }
+        check(!recorder.isRecording(), "recording stops after its duration");
+        check(SPIFFS.opens - opens == 1, "trace file opened once per recording");
+        check(recorder.getRecords() >= 33 && recorder.getDropped() == 0, "every register read recorded");
+        delete monitor;
+    }
+    TwoWire::detach(INA219_ADDRESS);
+
+    std::string recorded = std::string(SPIFFS.root()) + TRACE_FILE;
+    std::vector<TraceRecord> captured;
+    check(loadTrace(recorded.c_str(), captured) && !captured.empty(), "recorded trace readable on host");
+    if (!captured.empty()) {
+        ReplayResult rr = replay(captured);
+        check(!rr.samples.empty() && rr.samples.back().current > 799.5 && rr.samples.back().current < 800.5 &&
+              rr.samples.back().voltage > 4.99 && rr.samples.back().voltage < 5.01,
+              "recorded trace replays to the same readings");
+    }
+
+    return report("trace replay tests");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) return selfTest();
+
+    std::vector<TraceRecord> records;
+    if (!loadTrace(argv[1], records) || records.empty()) {
+        printf("cannot read trace %s\n", argv[1]);
+        return 1;
+    }
+    ReplayResult r = replay(records);
+    report(records, r);
+    if (argc >= 4 && strcmp(argv[2], "--csv") == 0) {
+        writeCsv(argv[3], r);
+    }
+    return 0;
+}